@@ -319,6 +319,11 @@ void OR1KArch::deleteCPU(ETISS_CPU *cpu)
     delete cpu;
 }
 
+size_t OR1KArch::getCPUStructSize() const
+{
+    return sizeof(OR1K_internal);
+}
+
 void OR1KArch::deleteVirtualStruct(etiss::VirtualStruct *stru)
 {
     delete stru;
@@ -572,6 +577,7 @@ class SPRField : public etiss::VirtualStruct::Field
     {
     }
     virtual ~SPRField() {}
+    virtual const void *getPointer() const { return &((OR1K *)parent_.structure_)->SPR[group_][index_]; }
 
   protected:
     virtual uint64_t _read() const { return (uint64_t)((OR1K *)parent_.structure_)->SPR[group_][index_]; }
@@ -595,6 +601,7 @@ class GPRField : public etiss::VirtualStruct::Field
     {
     }
     virtual ~GPRField() {}
+    virtual const void *getPointer() const { return &((OR1K *)parent_.structure_)->R[gprid_]; }
 
   protected:
     virtual uint64_t _read() const { return (uint64_t)((OR1K *)parent_.structure_)->R[gprid_]; }
@@ -612,6 +619,7 @@ class PPCField : public etiss::VirtualStruct::Field
   public:
     PPCField(etiss::VirtualStruct &parent) : Field(parent, std::string("PPC"), std::string("PPC"), R | W | F, 4) {}
     virtual ~PPCField() {}
+    virtual const void *getPointer() const { return ((OR1K *)parent_.structure_)->PPC; }
 
   protected:
     virtual uint64_t _read() const { return (uint64_t) * (((OR1K *)parent_.structure_)->PPC); }
@@ -627,6 +635,7 @@ class NPCField : public etiss::VirtualStruct::Field
   public:
     NPCField(etiss::VirtualStruct &parent) : Field(parent, std::string("NPC"), std::string("NPC"), R | W | F, 4) {}
     virtual ~NPCField() {}
+    virtual const void *getPointer() const { return ((OR1K *)parent_.structure_)->NPC; }
 
   protected:
     virtual uint64_t _read() const { return (uint64_t) * (((OR1K *)parent_.structure_)->NPC); }
@@ -642,6 +651,7 @@ class SRField : public etiss::VirtualStruct::Field
   public:
     SRField(etiss::VirtualStruct &parent) : Field(parent, std::string("SR"), std::string("SR_"), R | W | F, 4) {}
     virtual ~SRField() {}
+    virtual const void *getPointer() const { return ((OR1K *)parent_.structure_)->SR; }
 
   protected:
     virtual uint64_t _read() const { return (uint64_t) * (((OR1K *)parent_.structure_)->SR); }
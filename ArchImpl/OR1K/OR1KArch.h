@@ -80,6 +80,7 @@ class OR1KArch : public etiss::CPUArch
     virtual ETISS_CPU *newCPU();
     virtual void resetCPU(ETISS_CPU *cpu, etiss::uint64 *startpointer);
     virtual void deleteCPU(ETISS_CPU *);
+    virtual size_t getCPUStructSize() const;
     virtual std::shared_ptr<etiss::VirtualStruct> getVirtualStruct(ETISS_CPU *cpu);
     virtual void deleteVirtualStruct(etiss::VirtualStruct *stru);
 
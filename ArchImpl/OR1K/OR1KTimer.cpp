@@ -97,6 +97,25 @@ void OR1KTimer::changedRegister(const char *name)
     }
 }
 
+void OR1KTimer::saveState(std::vector<etiss::uint8> &state)
+{
+    int64_t regs[2] = { last_time_0_ps_, next_timer_match_ps_ };
+    state.assign((etiss::uint8 *)regs, (etiss::uint8 *)regs + sizeof(regs));
+}
+
+void OR1KTimer::restoreState(const std::vector<etiss::uint8> &state)
+{
+    int64_t regs[2];
+    if (state.size() != sizeof(regs))
+    {
+        etiss::log(etiss::ERROR, "OR1KTimer::restoreState: invalid state");
+        return;
+    }
+    memcpy(regs, state.data(), sizeof(regs));
+    last_time_0_ps_ = regs[0];
+    next_timer_match_ps_ = regs[1];
+}
+
 std::string OR1KTimer::_getPluginName() const
 {
     return "OR1KTimer";
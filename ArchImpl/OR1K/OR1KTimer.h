@@ -51,6 +51,9 @@ class ETISS_PLUGIN_EXPORT OR1KTimer : public etiss::CoroutinePlugin, public etis
     virtual ~OR1KTimer();
     virtual etiss::int32 execute();
     virtual void changedRegister(const char *name);
+    /// saves the internal registers for CPUCore::checkpoint; TTCR and TTMR are part of the cpu structure
+    virtual void saveState(std::vector<etiss::uint8> &state);
+    virtual void restoreState(const std::vector<etiss::uint8> &state);
 
   protected:
     virtual std::string _getPluginName() const;
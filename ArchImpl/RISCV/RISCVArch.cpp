@@ -191,6 +191,11 @@ void RISCVArch::deleteCPU(ETISS_CPU *cpu)
     delete (RISCV *) cpu ;
 }
 
+size_t RISCVArch::getCPUStructSize() const
+{
+    return sizeof(RISCV);
+}
+
 
 /**
 	@return 8 (jump instruction + instruction of delay slot)
@@ -66,6 +66,10 @@ class RISCVArch : public etiss::CPUArch
     virtual ETISS_CPU *newCPU();
     virtual void resetCPU(ETISS_CPU *cpu, etiss::uint64 *startpointer);
     virtual void deleteCPU(ETISS_CPU *);
+    /**
+            @return sizeof(RISCV)
+    */
+    virtual size_t getCPUStructSize() const;
 
     /**
             @brief get the VirtualStruct of the core to mitigate register access
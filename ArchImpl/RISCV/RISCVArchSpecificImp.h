@@ -534,6 +534,8 @@ public:
     {
     }
 
+    const void *getPointer() const override { return p_; }
+
 protected:
     uint64_t _read() const override { return (uint64_t)*p_; }
 
@@ -197,6 +197,11 @@ void RISCV64Arch::deleteCPU(ETISS_CPU *cpu)
     delete (RISCV64 *) cpu ;
 }
 
+size_t RISCV64Arch::getCPUStructSize() const
+{
+    return sizeof(RISCV64);
+}
+
 
 /**
 	@return 8 (jump instruction + instruction of delay slot)
@@ -70,6 +70,10 @@ class RISCV64Arch : public etiss::CPUArch
     virtual ETISS_CPU *newCPU();
     virtual void resetCPU(ETISS_CPU *cpu, etiss::uint64 *startpointer);
     virtual void deleteCPU(ETISS_CPU *);
+    /**
+            @return sizeof(RISCV64)
+    */
+    virtual size_t getCPUStructSize() const;
 
     /**
             @brief get the VirtualStruct of the core to mitigate register access
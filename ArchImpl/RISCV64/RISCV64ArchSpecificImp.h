@@ -563,6 +563,8 @@ class RegField : public etiss::VirtualStruct::Field
 
     virtual ~RegField() {}
 
+    virtual const void *getPointer() const { return ((RISCV64 *)parent_.structure_)->X[gprid_]; }
+
   protected:
     virtual uint64_t _read() const { return (uint64_t) * ((RISCV64 *)parent_.structure_)->X[gprid_]; }
 
@@ -580,6 +582,8 @@ class pcField : public etiss::VirtualStruct::Field
 
     virtual ~pcField() {}
 
+    virtual const void *getPointer() const { return &((ETISS_CPU *)parent_.structure_)->instructionPointer; }
+
   protected:
     virtual uint64_t _read() const { return (uint64_t)((ETISS_CPU *)parent_.structure_)->instructionPointer; }
 
@@ -608,6 +612,8 @@ class CSRField : public etiss::VirtualStruct::Field
 
     virtual ~CSRField() {}
 
+    virtual const void *getPointer() const { return csr_; }
+
   protected:
     virtual uint64_t _read() const { return (uint64_t)*csr_; }
 
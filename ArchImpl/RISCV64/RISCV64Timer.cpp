@@ -43,6 +43,7 @@
 #include "RISCV64Timer.h"
 #include "Encoding.h"
 #include "etiss/CPUArch.h"
+#include "etiss/EventQueue.h"
 
 static etiss_int32 iread(void *handle, ETISS_CPU *cpu, etiss_uint64 addr, etiss_uint32 length)
 {
@@ -61,12 +62,12 @@ static etiss_int32 iwrite(void *handle, ETISS_CPU *cpu, etiss_uint64 addr, etiss
 etiss_int32 dread(void *handle, ETISS_CPU *cpu, etiss_uint64 addr, etiss_uint8 *buffer, etiss_uint32 length)
 {
     RISCV64TimerSystem *lsys = ((RISCV64TimerSystem *)handle);
-    char *mtime_buf;
+    etiss::uint64 mtime;
     switch (addr & 0xfffffff0)
     {
     case MTIME_ADDR:
-        mtime_buf = (char *)(&(lsys->this_->mtime_));
-        memcpy(buffer, mtime_buf + (addr & 0x7), length);
+        mtime = lsys->this_->currentMtime();
+        memcpy(buffer, (char *)&mtime + (addr & 0x7), length);
         break;
     case MTIMECMP_ADDR:
 
@@ -89,6 +90,7 @@ static etiss_int32 dwrite(void *handle, ETISS_CPU *cpu, etiss_uint64 addr, etiss
 
     case MTIMECMP_ADDR:
         memcpy(lsys->this_->mtimecmp_buf_ + (addr & 0x7), buffer, length);
+        lsys->this_->scheduleAt(0); // apply the new compare value before the next block
         break;
 
     default:
@@ -101,12 +103,12 @@ static etiss_int32 dwrite(void *handle, ETISS_CPU *cpu, etiss_uint64 addr, etiss
 static etiss_int32 dbg_read(void *handle, etiss_uint64 addr, etiss_uint8 *buffer, etiss_uint32 length)
 {
     RISCV64TimerSystem *lsys = ((RISCV64TimerSystem *)handle);
-    char *mtime_buf;
+    etiss::uint64 mtime;
     switch (addr & 0xfffffff0)
     {
     case MTIME_ADDR:
-        mtime_buf = (char *)(&(lsys->this_->mtime_));
-        memcpy(buffer, mtime_buf + (addr & 0x7), length);
+        mtime = lsys->this_->currentMtime();
+        memcpy(buffer, (char *)&mtime + (addr & 0x7), length);
         break;
 
     case MTIMECMP_ADDR:
@@ -129,6 +131,7 @@ static etiss_int32 dbg_write(void *handle, etiss_uint64 addr, etiss_uint8 *buffe
 
     case MTIMECMP_ADDR:
         memcpy(lsys->this_->mtimecmp_buf_ + (addr & 0x7), buffer, length);
+        lsys->this_->scheduleAt(0); // apply the new compare value before the next block
         break;
 
     default:
@@ -189,10 +192,11 @@ etiss::int32 RISCV64Timer::execute()
     }
 
     if (!timer_enabled_)
-        return etiss::RETURNCODE::NOERROR;
+        return etiss::RETURNCODE::NOERROR; // woken up by a write to mtimecmp
 
     if (mtimecmp_overflow_ && !mtime_overflow_)
     {
+        scheduleAt(0); // poll until mtime overflows
         return etiss::RETURNCODE::NOERROR;
     }
     else if (mtime_ >= mtimecmp_ || (!mtimecmp_overflow_ && mtime_overflow_))
@@ -207,11 +211,60 @@ etiss::int32 RISCV64Timer::execute()
             else
                 mtimecmp_overflow_clear_ = true;
         }
+        scheduleAt(0); // signal the interrupt before every block until mtimecmp is written
         return etiss::RETURNCODE::INTERRUPT;
     }
+    // wake up when mtime reaches mtimecmp
+    const etiss::uint64 cycle_ps = ((ETISS_CPU *)riscv64cpu)->cpuCycleTime_ps;
+    scheduleAt(mtimecmp_ > etiss::EventQueue::NEVER / cycle_ps ? etiss::EventQueue::NEVER : mtimecmp_ * cycle_ps);
     return etiss::RETURNCODE::NOERROR;
 }
 
+namespace
+{
+struct TimerState
+{
+    etiss::uint64 mtime;
+    etiss::uint64 mtimecmp;
+    char mtimecmp_buf[8];
+    bool timer_enabled;
+    bool mtimecmp_overflow_clear;
+    bool mtimecmp_overflow;
+    bool mtime_overflow;
+};
+} // namespace
+
+void RISCV64Timer::saveState(std::vector<etiss::uint8> &state)
+{
+    TimerState ts;
+    ts.mtime = mtime_;
+    ts.mtimecmp = mtimecmp_;
+    memcpy(ts.mtimecmp_buf, mtimecmp_buf_, 8);
+    ts.timer_enabled = timer_enabled_;
+    ts.mtimecmp_overflow_clear = mtimecmp_overflow_clear_;
+    ts.mtimecmp_overflow = mtimecmp_overflow_;
+    ts.mtime_overflow = mtime_overflow_;
+    state.assign((etiss::uint8 *)&ts, (etiss::uint8 *)&ts + sizeof(ts));
+}
+
+void RISCV64Timer::restoreState(const std::vector<etiss::uint8> &state)
+{
+    if (state.size() != sizeof(TimerState))
+    {
+        etiss::log(etiss::ERROR, "RISCV64Timer::restoreState: invalid state");
+        return;
+    }
+    TimerState ts;
+    memcpy(&ts, state.data(), sizeof(ts));
+    mtime_ = ts.mtime;
+    mtimecmp_ = ts.mtimecmp;
+    memcpy(mtimecmp_buf_, ts.mtimecmp_buf, 8);
+    timer_enabled_ = ts.timer_enabled;
+    mtimecmp_overflow_clear_ = ts.mtimecmp_overflow_clear;
+    mtimecmp_overflow_ = ts.mtimecmp_overflow;
+    mtime_overflow_ = ts.mtime_overflow;
+}
+
 ETISS_System *RISCV64Timer::wrap(ETISS_CPU *cpu, ETISS_System *system)
 {
 
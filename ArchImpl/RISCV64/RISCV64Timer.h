@@ -74,6 +74,21 @@ class RISCV64Timer : public etiss::CoroutinePlugin, public etiss::SystemWrapperP
 
     etiss::int32 execute();
 
+    /// current value of mtime. mtime_ is only updated by execute, which may not run before every block
+    /// (etiss.event_queue)
+    etiss::uint64 currentMtime() const
+    {
+        return ((ETISS_CPU *)riscv64cpu)->cpuTime_ps / ((ETISS_CPU *)riscv64cpu)->cpuCycleTime_ps;
+    }
+
+    /// only executed when mtime reaches mtimecmp or mtimecmp is written (etiss.event_queue)
+    bool isEventDriven() { return true; }
+
+    /// saves mtime, mtimecmp and the overflow state for CPUCore::checkpoint
+    void saveState(std::vector<etiss::uint8> &state);
+
+    void restoreState(const std::vector<etiss::uint8> &state);
+
     ETISS_System *wrap(ETISS_CPU *cpu, ETISS_System *system);
 
     ETISS_System *unwrap(ETISS_CPU *cpu, ETISS_System *system);
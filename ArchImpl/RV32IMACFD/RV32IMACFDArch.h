@@ -74,6 +74,16 @@ public:
 	virtual void initInstrSet(etiss::instr::ModedInstructionSet & ) const;
 	virtual void initCodeBlock(etiss::CodeBlock & cb) const;
 
+	/**
+		@brief X registers may be kept in local variables of a block (jit.cache_registers)
+	*/
+	virtual bool getCachedRegisters(std::string & access, std::string & type, unsigned & count) const;
+
+	/**
+		@return sizeof(RV32IMACFD)
+	*/
+	virtual size_t getCPUStructSize() const;
+
 	/**
 		@brief Target architecture may have inconsistent endianess. Data read from memory is buffered, and this function
 			   is called to alter sequence of buffered data so that the inconsistent endianess is compensated.
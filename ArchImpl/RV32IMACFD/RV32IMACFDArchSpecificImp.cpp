@@ -512,3 +512,16 @@ void RV32IMACFDArch::deleteInterruptVector(etiss::InterruptVector * vec, ETISS_C
 {
 	delete vec;
 }
+
+bool RV32IMACFDArch::getCachedRegisters(std::string & access, std::string & type, unsigned & count) const
+{
+	access = "*((RV32IMACFD*)cpu)->X[";
+	type = "etiss_uint32";
+	count = 32;
+	return true;
+}
+
+size_t RV32IMACFDArch::getCPUStructSize() const
+{
+	return sizeof(RV32IMACFD);
+}
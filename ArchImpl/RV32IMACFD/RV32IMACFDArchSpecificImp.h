@@ -44,6 +44,10 @@ public:
 
 	virtual ~RegField_RV32IMACFD(){}
 
+	virtual const void *getPointer() const {
+		return ((RV32IMACFD*)parent_.structure_)->X[gprid_];
+	}
+
 protected:
 	virtual uint64_t _read() const {
 		return (uint64_t) *((RV32IMACFD*)parent_.structure_)->X[gprid_];
@@ -68,6 +72,10 @@ public:
 
 	virtual ~pcField_RV32IMACFD(){}
 
+	virtual const void *getPointer() const {
+		return &((ETISS_CPU *)parent_.structure_)->instructionPointer;
+	}
+
 protected:
 	virtual uint64_t _read() const {
 		return (uint64_t) ((ETISS_CPU *)parent_.structure_)->instructionPointer;
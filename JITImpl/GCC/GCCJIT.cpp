@@ -42,20 +42,89 @@
 
 #include "GCCJIT.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <dlfcn.h>
+#include <cstdio> // rename
+#include <dirent.h>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <stdint.h>
 #include <stdlib.h> //mkdtemp
+#include <sys/stat.h>
 #include <unistd.h>
 
-GCCJIT::GCCJIT(bool cleanup) : etiss::JIT("gcc"), cleanup_(cleanup)
+/// 64 bit FNV-1a hash. the string is terminated with a zero byte to keep concatenations unambiguous
+static void hashString(uint64_t &hash, const std::string &str)
+{
+    for (size_t i = 0; i <= str.size(); i++) // includes terminating zero
+    {
+        hash ^= (uint8_t)str.c_str()[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+/**
+    hashes the names and contents of all headers (*.h) below path in a stable order. symbolic links to folders are
+    not followed and at most depth levels of subfolders are searched
+*/
+static void hashHeaders(uint64_t &hash, const std::string &path, unsigned depth = 16)
+{
+    DIR *dir = opendir(path.c_str());
+    if (dir == 0)
+        return;
+    std::vector<std::string> names;
+    while (struct dirent *entry = readdir(dir))
+    {
+        const std::string name = entry->d_name;
+        if (name != "." && name != "..")
+            names.push_back(name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    for (const auto &name : names)
+    {
+        const std::string file = path + "/" + name;
+        struct stat st;
+        if (lstat(file.c_str(), &st) != 0)
+            continue;
+        if (S_ISDIR(st.st_mode))
+        {
+            if (depth > 0)
+                hashHeaders(hash, file, depth - 1);
+        }
+        else if (name.size() > 2 && name.compare(name.size() - 2, 2, ".h") == 0)
+        {
+            std::ifstream in(file.c_str(), std::ios::binary);
+            if (!in.is_open())
+                continue;
+            std::stringstream content;
+            content << in.rdbuf();
+            hashString(hash, name);
+            hashString(hash, content.str());
+        }
+    }
+}
+
+GCCJIT::GCCJIT(bool cleanup, std::string cachepath)
+    : etiss::JIT("gcc"), cleanup_(cleanup), cachepath_(cachepath), cache_hits_(0), cache_misses_(0), pch_uses_(0)
 {
 
     id = 0;
 
+    if (!cachepath_.empty())
+    {
+        if (system(std::string("mkdir -p \"" + cachepath_ + "\"").c_str()))
+        {
+            std::cerr << "ERROR: GCCJIT failed to create cache folder " << cachepath_ << ". Caching is disabled."
+                      << std::endl;
+            cachepath_.clear();
+        }
+    }
+
     if (system(std::string("mkdir -p \"./tmp\"").c_str()))
         std::cerr << "ERROR: GCCJIT failed to create ./tmp folder. this may lead to a failure to compile code."
                   << std::endl;
@@ -78,6 +147,12 @@ GCCJIT::GCCJIT(bool cleanup) : etiss::JIT("gcc"), cleanup_(cleanup)
 
 GCCJIT::~GCCJIT()
 {
+    if (!cachepath_.empty())
+        std::cout << "GCCJIT cache (" << cachepath_ << "): " << cache_hits_ << " hits, " << cache_misses_
+                  << " misses" << std::endl;
+    if (!prelude_headers_.empty())
+        std::cout << "GCCJIT: " << pch_uses_ << " compilations used a precompiled prelude" << std::endl;
+
     if (cleanup_)
         if (path_.substr(0, 6) == "./tmp/") // check path before recursive delete operation
             if (system(std::string("rm -R \"" + path_ + "\"").c_str()))
@@ -96,6 +171,61 @@ void *GCCJIT::translate(std::string code, std::set<std::string> headerpaths, std
 
     unsigned lid = id++;
 
+    std::stringstream flags;
+    flags << "-std=c99 -fPIC -march=native -mtune=native -pipe "; // CHANGED -Wall eliminated
+    if (debug)
+        flags << "-g -O0 ";
+    else
+        flags << "-Ofast ";
+    for (std::set<std::string>::const_iterator iter = headerpaths.begin(); iter != headerpaths.end(); iter++)
+    {
+        flags << "-I\"" << *iter << "\" ";
+    }
+
+    std::stringstream linkflags;
+    for (std::set<std::string>::const_iterator iter = librarypaths.begin();iter != librarypaths.end();iter++){
+            linkflags << " -L" << *iter << " ";
+    }
+
+    std::string cachefile;
+    if (!cachepath_.empty())
+    {
+        cachefile = getCacheFile(code, flags.str() + linkflags.str(), libraries, getHeaderHash(headerpaths));
+        if (access(cachefile.c_str(), R_OK) == 0)
+        {
+            void *lib = dlopen(cachefile.c_str(), RTLD_NOW | RTLD_LOCAL);
+            if (lib != 0)
+            {
+                cache_hits_++;
+                return lib;
+            }
+            // unusable cache entry; recompile and replace it
+        }
+        cache_misses_++;
+    }
+
+    // the prelude is replaced by an include of the header with the precompiled prelude
+    std::string preludeheader;
+    {
+        std::vector<std::string> preludes;
+        {
+            std::lock_guard<std::mutex> lock(prelude_mu_);
+            preludes = preludes_;
+        }
+        for (const auto &prelude : preludes)
+        {
+            if (code.compare(0, prelude.size(), prelude) != 0)
+                continue;
+            preludeheader = getPreludeHeader(prelude, flags.str(), getHeaderHash(headerpaths));
+            if (!preludeheader.empty())
+            {
+                code.erase(0, prelude.size());
+                pch_uses_++;
+            }
+            break;
+        }
+    }
+
     std::string codefilename;
     {
         std::ofstream codeFile;
@@ -113,15 +243,9 @@ void *GCCJIT::translate(std::string code, std::set<std::string> headerpaths, std
         codeFile.close();
     }
     std::stringstream ss;
-    ss << "gcc -c -std=c99 -fPIC -march=native -mtune=native -pipe "; // CHANGED -Wall eliminated
-    if (debug)
-        ss << "-g -O0 ";
-    else
-        ss << "-Ofast ";
-    for (std::set<std::string>::const_iterator iter = headerpaths.begin(); iter != headerpaths.end(); iter++)
-    {
-        ss << "-I\"" << *iter << "\" ";
-    }
+    ss << "gcc -c " << flags.str();
+    if (!preludeheader.empty())
+        ss << "-include \"" << preludeheader << "\" ";
     ss << path_ << codefilename << ".c"
        << " -o " << path_ << codefilename << ".o";
 
@@ -135,6 +259,16 @@ void *GCCJIT::translate(std::string code, std::set<std::string> headerpaths, std
         std::cout << "compiler failed with code: " << eval << std::endl;
     }
 
+    // with an enabled cache the library is linked to a process unique temporary file within the cache folder and
+    // then renamed. rename is atomic, thus concurrent runs sharing the cache never load partially written files
+    std::string libfilename = path_ + "lib" + codefilename + ".so";
+    if (!cachefile.empty())
+    {
+        std::stringstream tmpname;
+        tmpname << cachefile << "." << getpid() << "_" << lid << ".tmp";
+        libfilename = tmpname.str();
+    }
+
     ss.str("");
 
     ss << "gcc -shared ";
@@ -143,11 +277,9 @@ void *GCCJIT::translate(std::string code, std::set<std::string> headerpaths, std
             ss <<"-g -dl ";
     */
 
-    for (std::set<std::string>::const_iterator iter = librarypaths.begin();iter != librarypaths.end();iter++){
-            ss << " -L" << *iter << " ";
-    }
+    ss << linkflags.str();
 
-    ss << " -o " << path_ << "lib" << codefilename << ".so " << path_ << codefilename << ".o ";
+    ss << " -o " << libfilename << " " << path_ << codefilename << ".o ";
 
 
     for (std::set<std::string>::const_iterator iter = libraries.begin();iter != libraries.end();iter++){
@@ -170,7 +302,15 @@ void *GCCJIT::translate(std::string code, std::set<std::string> headerpaths, std
         std::cout << "compiler failed with code: " << eval << std::endl;
     }
 
-    void *lib = dlopen((path_ + "lib" + codefilename + std::string(".so")).c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!cachefile.empty() && eval == 0)
+    {
+        if (std::rename(libfilename.c_str(), cachefile.c_str()) == 0)
+            libfilename = cachefile;
+        else
+            std::cerr << "ERROR: GCCJIT failed to store " << cachefile << " in the cache" << std::endl;
+    }
+
+    void *lib = dlopen(libfilename.c_str(), RTLD_NOW | RTLD_LOCAL);
 
     if (lib == 0)
     {
@@ -180,6 +320,96 @@ void *GCCJIT::translate(std::string code, std::set<std::string> headerpaths, std
 
     return lib;
 }
+std::string GCCJIT::getCacheFile(const std::string &code, const std::string &flags,
+                                 const std::set<std::string> &libraries, uint64_t headerhash)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    hashString(hash, ETISS_VERSION_FULL);
+    hashString(hash, etiss::toString(headerhash));
+    hashString(hash, getName());
+    hashString(hash, flags);
+    for (std::set<std::string>::const_iterator iter = libraries.begin(); iter != libraries.end(); iter++)
+        hashString(hash, *iter);
+    hashString(hash, code);
+
+    std::stringstream ss;
+    ss << cachepath_ << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << ".so";
+    return ss.str();
+}
+
+void GCCJIT::setPrelude(const std::string &prelude)
+{
+    std::lock_guard<std::mutex> lock(prelude_mu_);
+    if (!prelude.empty() && std::find(preludes_.begin(), preludes_.end(), prelude) == preludes_.end())
+        preludes_.push_back(prelude);
+}
+
+uint64_t GCCJIT::getHeaderHash(const std::set<std::string> &headerpaths)
+{
+    std::lock_guard<std::mutex> lock(prelude_mu_);
+    auto entry = header_hashes_.find(headerpaths);
+    if (entry != header_hashes_.end())
+        return entry->second;
+    uint64_t hash = 14695981039346656037ULL;
+    for (const auto &path : headerpaths)
+    {
+        hashString(hash, path);
+        hashHeaders(hash, path);
+    }
+    header_hashes_[headerpaths] = hash;
+    return hash;
+}
+
+std::string GCCJIT::getPreludeHeader(const std::string &prelude, const std::string &flags, uint64_t headerhash)
+{
+    std::lock_guard<std::mutex> lock(prelude_mu_);
+    const std::string key = prelude + '\0' + flags + '\0' + etiss::toString(headerhash);
+    auto entry = prelude_headers_.find(key);
+    if (entry != prelude_headers_.end())
+        return entry->second;
+
+    // gcc uses <header>.gch instead of <header> if it was built with compatible flags
+    uint64_t hash = 14695981039346656037ULL;
+    hashString(hash, ETISS_VERSION_FULL);
+    hashString(hash, etiss::toString(headerhash));
+    hashString(hash, flags);
+    hashString(hash, prelude);
+    std::stringstream ss;
+    ss << (cachepath_.empty() ? path_ : cachepath_ + "/") << "prelude_" << std::hex << std::setw(16)
+       << std::setfill('0') << hash << ".h";
+    std::string header = ss.str();
+    const std::string gch = header + ".gch";
+
+    if (access(header.c_str(), R_OK) != 0 || access(gch.c_str(), R_OK) != 0)
+    {
+        // built under process unique names and renamed (gch first) for concurrent runs sharing the cache
+        std::stringstream suffix;
+        suffix << "." << getpid() << ".tmp";
+        const std::string tmpheader = header + suffix.str();
+        const std::string tmpgch = gch + suffix.str();
+        bool ok;
+        {
+            std::ofstream out(tmpheader.c_str());
+            out << prelude;
+            out.close();
+            ok = !out.fail();
+        }
+        ok = ok && system(std::string("gcc -x c-header " + flags + "\"" + tmpheader + "\" -o \"" + tmpgch + "\"")
+                              .c_str()) == 0;
+        ok = ok && std::rename(tmpgch.c_str(), gch.c_str()) == 0 && std::rename(tmpheader.c_str(), header.c_str()) == 0;
+        if (!ok)
+        {
+            std::cerr << "ERROR: GCCJIT failed to build the precompiled prelude " << gch << std::endl;
+            std::remove(tmpheader.c_str());
+            std::remove(tmpgch.c_str());
+            header.clear();
+        }
+    }
+
+    prelude_headers_[key] = header;
+    return header;
+}
+
 void *GCCJIT::getFunction(void *handle, std::string name, std::string &error)
 {
     void *ret = dlsym(handle, name.c_str());
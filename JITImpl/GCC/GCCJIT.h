@@ -42,23 +42,54 @@
 
 #include "etiss/JIT.h"
 
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
 /**
         @brief provides compilation via gcc and load the compilation result with dlopen/dlsym functions
-        @detail use the option "cleanup" -> "false" to keep code after destruction of a GCCJIT instance
+        @detail use the option "cleanup" -> "false" to keep code after destruction of a GCCJIT instance.
+                If a cache path is given (option "jit.gcc.cache_path") compiled libraries are additionally stored
+                in that folder under a hash of the code, all compilation parameters and the headers in the include
+                folders. Later translations (also of
+                other processes/runs) with the same hash load the cached library directly without invoking gcc.
+                The cache is only valid on the machine that created it (-march=native)
+                Code that starts with a prelude announced by setPrelude is compiled with a precompiled header (.gch)
+                of the prelude, which is built once per compiler flags in the cache folder (or the working folder)
 */
 class GCCJIT : public etiss::JIT
 {
   public:
-    GCCJIT(bool cleanup = true);
+    GCCJIT(bool cleanup = true, std::string cachepath = "");
     virtual ~GCCJIT();
     virtual void *translate(std::string code, std::set<std::string> headerpaths, std::set<std::string> librarypaths,
                             std::set<std::string> libraries, std::string &error, bool debug = false);
     virtual void *getFunction(void *handle, std::string name, std::string &error);
     virtual void free(void *handle);
+    virtual bool isThreadSafe() { return true; }
+    virtual bool optimizesTailCalls(bool debug) { return !debug; } // sibling calls at -Ofast
+    virtual void setPrelude(const std::string &prelude);
 
   private:
+    /// returns the path of the cached library for the given compilation parameters
+    std::string getCacheFile(const std::string &code, const std::string &flags, const std::set<std::string> &libraries,
+                             uint64_t headerhash);
+    /// returns the path of a header with the prelude whose precompiled header matches flags; builds it if needed
+    std::string getPreludeHeader(const std::string &prelude, const std::string &flags, uint64_t headerhash);
+    /// hash of the headers in the include folders. keeps cached libraries from outliving structure layout changes
+    uint64_t getHeaderHash(const std::set<std::string> &headerpaths);
+
   private:
-    unsigned id;
+    std::atomic<unsigned> id;
     std::string path_;
     bool cleanup_;
+    std::string cachepath_;
+    std::atomic<unsigned> cache_hits_;
+    std::atomic<unsigned> cache_misses_;
+    std::mutex prelude_mu_;
+    std::vector<std::string> preludes_;
+    std::map<std::string, std::string> prelude_headers_; ///< header paths by prelude and flags; empty if failed
+    std::map<std::set<std::string>, uint64_t> header_hashes_; ///< getHeaderHash results; headers don't change at runtime
+    std::atomic<unsigned> pch_uses_;
 };
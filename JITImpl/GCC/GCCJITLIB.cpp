@@ -63,7 +63,10 @@ extern "C"
     {
         etiss::Configuration cfg;
         cfg.config() = options;
-        return new GCCJIT(cfg.get<bool>("jit.gcc.cleanup", true));
+        std::string cachepath = cfg.isSet("jit.gcc.cache_path")
+                                    ? cfg.get<std::string>("jit.gcc.cache_path", "")
+                                    : etiss::cfg().get<std::string>("jit.gcc.cache_path", "");
+        return new GCCJIT(cfg.get<bool>("jit.gcc.cleanup", true), cachepath);
     }
 
     void GCCJIT_deleteJIT(etiss::JIT *jit) { delete (GCCJIT *)jit; }
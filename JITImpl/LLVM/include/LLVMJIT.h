@@ -60,6 +60,7 @@
 #include "clang/Basic/TargetOptions.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Serialization/InMemoryModuleCache.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/Analysis/LoopPass.h"
 #include "llvm/Analysis/Passes.h"
@@ -100,6 +101,12 @@ class OrcJit;
 namespace etiss
 {
 
+/**
+        @brief compiles code in process with clang and the llvm orc jit
+        @detail file manager, diagnostics and the in memory cache of precompiled headers persist across
+                translations. code that starts with a prelude announced by setPrelude is compiled with a precompiled
+                header of that prelude that is built on first use
+*/
 class LLVMJIT : public etiss::JIT
 {
   public:
@@ -109,12 +116,29 @@ class LLVMJIT : public etiss::JIT
                             std::set<std::string> libraries, std::string &error, bool debug = false);
     virtual void *getFunction(void *handle, std::string name, std::string &error);
     virtual void free(void *handle);
+    virtual void setPrelude(const std::string &prelude);
+    virtual bool optimizesTailCalls(bool debug) { return !debug; } // sibling calls at -O3
+
+  private:
+    /// sets up a compiler instance with the persistent compiler state
+    void initCompiler(clang::CompilerInstance &CI);
+    /// builds a precompiled header of prelude with the given compiler arguments. @return path or empty on failure
+    std::string buildPCH(const std::string &prelude, const std::vector<std::string> &args);
 
   private:
     llvm::LLVMContext context_;
     OrcJit *orcJit_ = nullptr;
     std::unordered_set<std::string> loadedLibs_;
 
+    llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> diagOpts_;
+    std::unique_ptr<clang::TextDiagnosticPrinter> diagPrinter_;
+    llvm::IntrusiveRefCntPtr<clang::FileManager> fileManager_;
+    llvm::IntrusiveRefCntPtr<clang::InMemoryModuleCache> moduleCache_;
+    std::vector<std::string> preludes_;
+    std::map<std::string, std::string> pchs_; ///< precompiled header paths by prelude and compiler arguments
+    unsigned fileCount_ = 0;
+    unsigned pchHits_ = 0;
+
 };
 
 } // namespace etiss
@@ -63,10 +63,13 @@
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Scalar/GVN.h"
 #include "clang/Basic/FileManager.h"
+#include "clang/Frontend/FrontendActions.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 
+#include <algorithm>
 #include <vector>
 #include <iostream>
+#include <sstream>
 
 using namespace etiss;
 
@@ -190,29 +193,89 @@ LLVMJIT::LLVMJIT() : JIT("LLVMJIT")
     if (!orcJit)
         throw std::runtime_error("fail");
     orcJit_ = (*orcJit).release();
+
+    diagOpts_ = new DiagnosticOptions();
+    diagPrinter_.reset(new TextDiagnosticPrinter(llvm::outs(), diagOpts_.get()));
+    fileManager_ = new FileManager(FileSystemOptions());
+    moduleCache_ = new InMemoryModuleCache();
 }
 
 LLVMJIT::~LLVMJIT()
 {
+    if (!pchs_.empty())
+        std::cout << "LLVMJIT: " << pchHits_ << " translations used a precompiled prelude" << std::endl;
+    for (const auto &pch : pchs_)
+    {
+        if (pch.second.empty())
+            continue;
+        llvm::sys::fs::remove(pch.second);
+        llvm::sys::fs::remove(pch.second.substr(0, pch.second.size() - 4)); // prelude header
+    }
     delete orcJit_;
 }
 
-void *LLVMJIT::translate(std::string code, std::set<std::string> headerpaths, std::set<std::string> librarypaths,
-                         std::set<std::string> libraries, std::string &error, bool debug)
+void LLVMJIT::setPrelude(const std::string &prelude)
 {
-    clang::CompilerInstance CI;
-
-    DiagnosticOptions *diagOpts = new DiagnosticOptions();
-    TextDiagnosticPrinter *diagPrinter = new TextDiagnosticPrinter(llvm::outs(), diagOpts);
+    if (!prelude.empty() && std::find(preludes_.begin(), preludes_.end(), prelude) == preludes_.end())
+        preludes_.push_back(prelude);
+}
 
-    CI.createDiagnostics(diagPrinter);
+void LLVMJIT::initCompiler(clang::CompilerInstance &CI)
+{
+    CI.createDiagnostics(diagPrinter_.get(), false);
     auto pto = std::make_shared<clang::TargetOptions>();
     pto->Triple = llvm::sys::getDefaultTargetTriple();
     TargetInfo *pti = TargetInfo::CreateTargetInfo(CI.getDiagnostics(), pto);
     CI.setTarget(pti);
-    CI.createFileManager();
+    // file lookups and contents of headers are cached across translations
+    CI.setFileManager(fileManager_.get());
     CI.createSourceManager(CI.getFileManager());
-    CI.createPreprocessor(clang::TranslationUnitKind::TU_Module);
+}
+
+std::string LLVMJIT::buildPCH(const std::string &prelude, const std::vector<std::string> &args)
+{
+    SmallString<128> header;
+    int fd;
+    if (llvm::sys::fs::createTemporaryFile("etiss_prelude", "h", fd, header))
+        return "";
+    {
+        llvm::raw_fd_ostream out(fd, true);
+        out << prelude;
+    }
+    const std::string headerfile = header.str().str();
+    const std::string pch = headerfile + ".pch";
+
+    clang::CompilerInstance CI(std::make_shared<PCHContainerOperations>(), moduleCache_.get());
+    initCompiler(CI);
+
+    std::vector<const char *> argsCStr;
+    for (const auto &arg : args)
+    {
+        argsCStr.push_back(arg.c_str());
+    }
+    argsCStr.push_back("-x");
+    argsCStr.push_back("c-header");
+    argsCStr.push_back(headerfile.c_str());
+    argsCStr.push_back("-o");
+    argsCStr.push_back(pch.c_str());
+
+    GeneratePCHAction action;
+    if (!CompilerInvocation::CreateFromArgs(CI.getInvocation(), argsCStr, CI.getDiagnostics()) ||
+        !CI.ExecuteAction(action))
+    {
+        std::cout << "LLVMJIT: failed to build precompiled prelude; compiling without" << std::endl;
+        llvm::sys::fs::remove(headerfile);
+        llvm::sys::fs::remove(pch);
+        return "";
+    }
+    return pch;
+}
+
+void *LLVMJIT::translate(std::string code, std::set<std::string> headerpaths, std::set<std::string> librarypaths,
+                         std::set<std::string> libraries, std::string &error, bool debug)
+{
+    clang::CompilerInstance CI(std::make_shared<PCHContainerOperations>(), moduleCache_.get());
+    initCompiler(CI);
 
     // compilation task
     std::vector<std::string> args;
@@ -232,7 +295,6 @@ void *LLVMJIT::translate(std::string code, std::set<std::string> headerpaths, st
     {
         args.push_back("-isystem" + headerPath);
     }
-    args.push_back("/etiss_llvm_clang_memory_mapped_file.c");
     args.push_back("-isystem/usr/include/x86_64-linux-gnu");
 
     for (const auto &lib : libraries)
@@ -248,6 +310,38 @@ void *LLVMJIT::translate(std::string code, std::set<std::string> headerpaths, st
         }
     }
 
+    // the prelude of the code is replaced by its precompiled header, built once per set of compiler arguments
+    for (const auto &prelude : preludes_)
+    {
+        if (code.compare(0, prelude.size(), prelude) != 0)
+            continue;
+        std::string key = prelude;
+        for (const auto &arg : args)
+        {
+            key += '\0' + arg;
+        }
+        auto pch = pchs_.find(key);
+        if (pch == pchs_.end())
+            pch = pchs_.insert(std::make_pair(key, buildPCH(prelude, args))).first;
+        if (!pch->second.empty())
+        {
+            args.push_back("-include-pch");
+            args.push_back(pch->second);
+            code.erase(0, prelude.size());
+            pchHits_++;
+        }
+        break;
+    }
+
+    // every translation uses a new file name since the file manager keeps the entries of previous files
+    std::string filename;
+    {
+        std::stringstream ss;
+        ss << "/etiss_llvm_clang_memory_mapped_file_" << fileCount_++ << ".c";
+        filename = ss.str();
+    }
+    args.push_back(filename);
+
     // configure compiler call
     std::vector<const char *> argsCStr;
     for (const auto &arg : args)
@@ -261,10 +355,9 @@ void *LLVMJIT::translate(std::string code, std::set<std::string> headerpaths, st
     }
 
     // input file is mapped to memory area containing the code
-    auto buffer = MemoryBuffer::getMemBufferCopy(code, "/etiss_llvm_clang_memory_mapped_file.c");
+    auto buffer = MemoryBuffer::getMemBufferCopy(code, filename);
     CI.getSourceManager().overrideFileContents(
-        CI.getFileManager().getVirtualFile("/etiss_llvm_clang_memory_mapped_file.c", buffer->getBufferSize(), 0),
-        buffer.get(), true);
+        CI.getFileManager().getVirtualFile(filename, buffer->getBufferSize(), 0), buffer.get(), true);
 
     // compiler should only output llvm module
 
@@ -0,0 +1,280 @@
+/*
+
+        @copyright
+
+        <pre>
+
+        Copyright 2018 Infineon Technologies AG
+
+        This file is part of ETISS tool, see <https://github.com/tum-ei-eda/etiss>.
+
+        The initial version of this software has been created with the funding support by the German Federal
+        Ministry of Education and Research (BMBF) in the project EffektiV under grant 01IS13022.
+
+        Redistribution and use in source and binary forms, with or without modification, are permitted
+        provided that the following conditions are met:
+
+        1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+        the following disclaimer.
+
+        2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+        and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+        3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+        or promote products derived from this software without specific prior written permission.
+
+        THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+        WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+        PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+        DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+        PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+        HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+        NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+        POSSIBILITY OF SUCH DAMAGE.
+
+        </pre>
+
+        @author Chair of Electronic Design Automation, TUM
+
+        @version 0.1
+
+*/
+/**
+        @file
+
+        @brief lookup table from exact instruction indices to translated blocks
+
+        @detail used by etiss::Translation to find blocks by their start index without hashing and list traversal
+
+*/
+#ifndef ETISS_INCLUDE_BLOCKLOOKUPTABLE_H_
+#define ETISS_INCLUDE_BLOCKLOOKUPTABLE_H_
+
+#include "etiss/Misc.h"
+
+#include <cstring>
+#include <vector>
+
+namespace etiss
+{
+
+/**
+        @brief maps exact instruction indices to pointers (e.g. etiss::BlockLink). even indices below 2^32 are stored
+   in a three level page table (10/10/11 bit); all other indices in an open addressed hash table with linear probing.
+   a small direct mapped jump target cache in front of both serves repeated lookups of the same targets (e.g.
+   returns and other indirect branches) with a single compare.
+        @detail the table stores plain pointers and holds no references. erase entries before the referenced object
+   is deleted.
+*/
+template <typename T>
+class BlockLookupTable
+{
+  public:
+    BlockLookupTable() : hashsize_(0)
+    {
+        memset(l1_, 0, sizeof(l1_));
+        memset(jtc_, 0, sizeof(jtc_));
+    }
+    ~BlockLookupTable() { clear(); }
+    BlockLookupTable(const BlockLookupTable &) = delete;
+    BlockLookupTable &operator=(const BlockLookupTable &) = delete;
+
+    /// @return the value stored for index or nullptr
+    inline T *find(etiss::uint64 index)
+    {
+        JTCEntry &jtc = jtc_[jtcIndex(index)];
+        if (likely(jtc.index == index && jtc.value != nullptr))
+            return jtc.value;
+        T *ret = lookup(index);
+        if (ret != nullptr)
+        {
+            jtc.index = index;
+            jtc.value = ret;
+        }
+        return ret;
+    }
+
+    /// stores value for index. an existing value is replaced
+    void insert(etiss::uint64 index, T *value)
+    {
+        JTCEntry &jtc = jtc_[jtcIndex(index)];
+        if (jtc.index == index)
+            jtc.value = value;
+        if (isPaged(index))
+        {
+            T ***&l2 = l1_[l1Index(index)];
+            if (l2 == nullptr)
+            {
+                l2 = new T **[1 << L2_BITS];
+                memset(l2, 0, sizeof(T **) * (1 << L2_BITS));
+            }
+            T **&l3 = l2[l2Index(index)];
+            if (l3 == nullptr)
+            {
+                l3 = new T *[1 << L3_BITS];
+                memset(l3, 0, sizeof(T *) * (1 << L3_BITS));
+            }
+            l3[l3Index(index)] = value;
+            return;
+        }
+        if ((hashsize_ + 1) * 2 > hash_.size())
+            rehash(hash_.empty() ? 64 : hash_.size() * 2);
+        size_t mask = hash_.size() - 1;
+        for (size_t i = hashIndex(index) & mask;; i = (i + 1) & mask)
+        {
+            if (hash_[i].value == nullptr)
+            {
+                hash_[i].index = index;
+                hash_[i].value = value;
+                hashsize_++;
+                return;
+            }
+            if (hash_[i].index == index)
+            {
+                hash_[i].value = value;
+                return;
+            }
+        }
+    }
+
+    /// removes the entry for index if it holds value
+    void erase(etiss::uint64 index, T *value)
+    {
+        JTCEntry &jtc = jtc_[jtcIndex(index)];
+        if (jtc.index == index && jtc.value == value)
+            jtc.value = nullptr;
+        if (isPaged(index))
+        {
+            T ***l2 = l1_[l1Index(index)];
+            if (l2 == nullptr)
+                return;
+            T **l3 = l2[l2Index(index)];
+            if (l3 == nullptr)
+                return;
+            if (l3[l3Index(index)] == value)
+                l3[l3Index(index)] = nullptr;
+            return;
+        }
+        if (hash_.empty())
+            return;
+        size_t mask = hash_.size() - 1;
+        size_t i = hashIndex(index) & mask;
+        while (hash_[i].value != nullptr && hash_[i].index != index)
+            i = (i + 1) & mask;
+        if (hash_[i].value != value || value == nullptr)
+            return;
+        // backward shift deletion keeps probe sequences intact without tombstones
+        hash_[i].value = nullptr;
+        hashsize_--;
+        for (size_t j = (i + 1) & mask; hash_[j].value != nullptr; j = (j + 1) & mask)
+        {
+            size_t home = hashIndex(hash_[j].index) & mask;
+            bool keep = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+            if (keep)
+                continue;
+            hash_[i] = hash_[j];
+            hash_[j].value = nullptr;
+            i = j;
+        }
+    }
+
+    /// removes all entries and frees the page table
+    void clear()
+    {
+        for (size_t i = 0; i < (1 << L1_BITS); i++)
+        {
+            if (l1_[i] == nullptr)
+                continue;
+            for (size_t j = 0; j < (1 << L2_BITS); j++)
+                delete[] l1_[i][j];
+            delete[] l1_[i];
+            l1_[i] = nullptr;
+        }
+        hash_.clear();
+        hashsize_ = 0;
+        memset(jtc_, 0, sizeof(jtc_));
+    }
+
+  private:
+    static const unsigned L1_BITS = 10;
+    static const unsigned L2_BITS = 10;
+    static const unsigned L3_BITS = 11; // + 1 bit alignment = 32 bit
+    static const unsigned JTC_BITS = 8;
+
+    struct JTCEntry
+    {
+        etiss::uint64 index;
+        T *value;
+    };
+    struct HashEntry
+    {
+        etiss::uint64 index;
+        T *value;
+    };
+
+    static inline bool isPaged(etiss::uint64 index) { return (index >> 32) == 0 && (index & 1) == 0; }
+    static inline size_t l1Index(etiss::uint64 index) { return (size_t)(index >> (1 + L3_BITS + L2_BITS)); }
+    static inline size_t l2Index(etiss::uint64 index)
+    {
+        return (size_t)(index >> (1 + L3_BITS)) & ((1 << L2_BITS) - 1);
+    }
+    static inline size_t l3Index(etiss::uint64 index) { return (size_t)(index >> 1) & ((1 << L3_BITS) - 1); }
+    static inline size_t jtcIndex(etiss::uint64 index)
+    {
+        return (size_t)((index >> 1) ^ (index >> (1 + JTC_BITS))) & ((1 << JTC_BITS) - 1);
+    }
+    static inline size_t hashIndex(etiss::uint64 index)
+    {
+        return (size_t)((index * 0x9E3779B97F4A7C15ULL) >> 32);
+    }
+
+    inline T *lookup(etiss::uint64 index) const
+    {
+        if (likely(isPaged(index)))
+        {
+            T ***l2 = l1_[l1Index(index)];
+            if (l2 == nullptr)
+                return nullptr;
+            T **l3 = l2[l2Index(index)];
+            if (l3 == nullptr)
+                return nullptr;
+            return l3[l3Index(index)];
+        }
+        if (hash_.empty())
+            return nullptr;
+        size_t mask = hash_.size() - 1;
+        for (size_t i = hashIndex(index) & mask; hash_[i].value != nullptr; i = (i + 1) & mask)
+        {
+            if (hash_[i].index == index)
+                return hash_[i].value;
+        }
+        return nullptr;
+    }
+
+    void rehash(size_t size)
+    {
+        std::vector<HashEntry> old(size, HashEntry{ 0, nullptr });
+        old.swap(hash_);
+        hashsize_ = 0;
+        size_t mask = hash_.size() - 1;
+        for (auto &e : old)
+        {
+            if (e.value == nullptr)
+                continue;
+            size_t i = hashIndex(e.index) & mask;
+            while (hash_[i].value != nullptr)
+                i = (i + 1) & mask;
+            hash_[i] = e;
+            hashsize_++;
+        }
+    }
+
+    T ***l1_[1 << L1_BITS];
+    JTCEntry jtc_[1 << JTC_BITS];
+    std::vector<HashEntry> hash_;
+    size_t hashsize_;
+};
+
+} // namespace etiss
+
+#endif // ETISS_INCLUDE_BLOCKLOOKUPTABLE_H_
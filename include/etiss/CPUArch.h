@@ -193,6 +193,12 @@ class CPUArch : public CPUArchRegListenerInterface,
             @brief delete cpu structure
     */
     virtual void deleteCPU(ETISS_CPU *) = 0;
+    /**
+            @brief size of the structure allocated by newCPU. the structure may only contain pointers into itself so
+       that a copy can be written back to the same structure (see CPUCore::checkpoint)
+            @return 0 if the size is unknown
+    */
+    virtual size_t getCPUStructSize() const { return 0; }
     /**
             used for variable instruction size and delay slots
             @deprecated use getMaximumInstructionsPerMetaInstruction()
@@ -262,6 +268,17 @@ class CPUArch : public CPUArchRegListenerInterface,
      */
     virtual etiss::mm::MMU *newMMU(ETISS_CPU *cpu) { return nullptr; }
 
+    /**
+            @brief describes the general purpose register accesses of the generated code for register caching in local
+       variables (jit.cache_registers, see etiss::CodeBlock::cacheRegisters)
+            @param access code of an access to register i without i and the closing bracket (e.g.
+       "*((RV32IMACFD*)cpu)->X[")
+            @param type C type of a register
+            @param count number of registers
+            @return false if register caching is not supported
+    */
+    virtual bool getCachedRegisters(std::string &access, std::string &type, unsigned &count) const { return false; }
+
   protected:
     /// do not override. maps to getName().
     virtual std::string _getPluginName() const;
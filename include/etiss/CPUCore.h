@@ -56,6 +56,7 @@
 #include "etiss/LibraryInterface.h"
 #include "etiss/JIT.h"
 #include "etiss/CPUArch.h"
+#include "etiss/EventQueue.h"
 #include "etiss/Translation.h"
 #include "etiss/System.h"
 #include "etiss/InterruptHandler.h"
@@ -68,6 +69,7 @@
 #include <mutex>
 #include <memory>
 #include <list>
+#include <map>
 
 namespace etiss
 {
@@ -258,6 +260,39 @@ class CPUCore : public VirtualStructSupport, public etiss::ToString
      */
     inline void setBlockChainCount(unsigned bcc) { bcc_ = bcc; }
 
+    /**
+     * @brief Adds an address range [start,end) of code that is translated before the simulation starts if
+     * jit.pretranslate is set (e.g. the executable segments of an ELF file).
+     */
+    inline void addPretranslationRange(etiss::uint64 start, etiss::uint64 end)
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        pretranslation_ranges_.push_back(std::make_pair(start, end));
+    }
+
+    /**
+     * @brief Saves the cpu structure (registers, CSRs, time), the state of
+     * the plugins (see Plugin::saveState) and the fault injection triggers
+     * that have not fired yet. Replaces a previous checkpoint.
+     *
+     * @details The memory of the system must be saved separately (e.g.
+     * SimpleMemSystem::checkpoint). Unlike the other methods of this class it
+     * doesn't lock the core and may be called by plugins during execute() (e.g.
+     * by a CoroutinePlugin). Restoring during execute() keeps the translated
+     * code; code that was written after the checkpoint is not unloaded.
+     *
+     * @return false if the architecture doesn't support checkpoints (see
+     * CPUArch::getCPUStructSize) or the core uses a MMU.
+     */
+    bool checkpoint();
+
+    /**
+     * @brief Restores the state saved by checkpoint().
+     *
+     * @return false if there is no checkpoint.
+     */
+    bool restore();
+
     /**
      * @brief Start the simulation of the CPU core for the system model.
      *
@@ -393,6 +428,10 @@ class CPUCore : public VirtualStructSupport, public etiss::ToString
     int blockCacheLimit_; /// TODO: possibility to limit the cache size
     bool mmu_enabled_;
     std::shared_ptr<etiss::mm::MMU> mmu_;
+    std::vector<std::pair<etiss::uint64, etiss::uint64>> pretranslation_ranges_; /// code ranges to translate ahead of execution
+    std::vector<etiss::uint8> checkpoint_cpu_; /// copy of cpu_ taken by checkpoint(); empty if there is none
+    std::map<Plugin *, std::vector<etiss::uint8>> checkpoint_plugins_; /// plugin states taken by checkpoint()
+    etiss::EventQueue events_; /// wake-ups of event driven coroutine plugins (etiss.event_queue)
 
   public:
     uint64_t instrcounter; /// this field is always present to maintain API compatibility but it is only used if
@@ -57,6 +57,7 @@ class RegisterDevicePlugin;
 class InterruptListenerPlugin;
 
 class Translation;
+class EventQueue;
 
 namespace instr
 {
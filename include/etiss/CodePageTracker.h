@@ -0,0 +1,136 @@
+/*
+
+        @copyright
+
+        <pre>
+
+        Copyright 2018 Infineon Technologies AG
+
+        This file is part of ETISS tool, see <https://github.com/tum-ei-eda/etiss>.
+
+        The initial version of this software has been created with the funding support by the German Federal
+        Ministry of Education and Research (BMBF) in the project EffektiV under grant 01IS13022.
+
+        Redistribution and use in source and binary forms, with or without modification, are permitted
+        provided that the following conditions are met:
+
+        1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+        the following disclaimer.
+
+        2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+        and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+        3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+        or promote products derived from this software without specific prior written permission.
+
+        THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+        WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+        PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+        DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+        PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+        HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+        NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+        POSSIBILITY OF SUCH DAMAGE.
+
+        </pre>
+
+        @author Chair of Electronic Design Automation, TUM
+
+        @version 0.1
+
+*/
+/**
+        @file
+
+        @brief tracks writes to memory that contains translated code
+
+*/
+
+#ifndef ETISS_INCLUDE_CODEPAGETRACKER_H_
+#define ETISS_INCLUDE_CODEPAGETRACKER_H_
+
+#include "etiss/Plugin.h"
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+namespace etiss
+{
+
+/**
+        @brief SystemWrapperPlugin that records writes (dwrite, iwrite, dbg_write) to memory regions containing
+   translated code. etiss::Translation marks translated address ranges with addCode and invalidates the blocks of
+   written regions (see etiss::Translation::invalidateWrittenCode). memory is tracked in regions of 1 KiB; regions
+   below 4 GiB are stored in a lazily allocated two level bitmap.
+*/
+class CodePageTracker : public etiss::SystemWrapperPlugin
+{
+  public:
+    static const unsigned REGION_BITS = 10; ///< log2 of the size of a tracked region
+
+    CodePageTracker();
+    virtual ~CodePageTracker();
+
+    ETISS_System *wrap(ETISS_CPU *cpu, ETISS_System *system);
+    ETISS_System *unwrap(ETISS_CPU *cpu, ETISS_System *system);
+
+    /**
+            @brief sets the chain budget of etiss::Translation (see ETISS_BlockChain::budget). a write to code clears
+       it so that a chain returns to the simulation loop after the writing block instead of calling a successor whose
+       code has just been overwritten
+    */
+    void setChainBudget(etiss::int32 *budget) { chainbudget_ = budget; }
+
+    /// marks [start,end) as containing translated code
+    void addCode(etiss::uint64 start, etiss::uint64 end);
+
+    /// records a write to [addr,addr+len)
+    inline void written(etiss::uint64 addr, etiss::uint32 len)
+    {
+        if (unlikely(len == 0))
+            return;
+        const etiss::uint64 last = (addr + len - 1) >> REGION_BITS;
+        for (etiss::uint64 region = addr >> REGION_BITS; region <= last; region++)
+        {
+            if (unlikely(isCode(region)))
+                markWritten(region);
+        }
+    }
+
+    /// @return true if code has been written since the last call of takeWrittenRegions
+    inline bool hasWrittenCode() const { return !written_.empty(); }
+
+    /**
+            @brief returns the start addresses of all written code regions and clears the list. the regions are no
+       longer marked as code
+    */
+    std::vector<etiss::uint64> takeWrittenRegions();
+
+  protected:
+    std::string _getPluginName() const;
+
+  private:
+    static const unsigned CHUNK_BITS = 12; ///< log2 of regions per bitmap chunk
+
+    inline bool isCode(etiss::uint64 region) const
+    {
+        if (unlikely((region >> (32 - REGION_BITS)) != 0))
+            return highcode_.find(region) != highcode_.end();
+        const etiss::uint64 *chunk = chunks_[region >> CHUNK_BITS].get();
+        if (chunk == nullptr)
+            return false;
+        const etiss::uint64 bit = region & ((1 << CHUNK_BITS) - 1);
+        return (chunk[bit >> 6] >> (bit & 63)) & 1;
+    }
+    void markWritten(etiss::uint64 region);
+
+    std::vector<std::unique_ptr<etiss::uint64[]>> chunks_;
+    std::unordered_set<etiss::uint64> highcode_; ///< code regions above 4 GiB
+    std::vector<etiss::uint64> written_;         ///< written code regions
+    etiss::int32 *chainbudget_;
+};
+
+} // namespace etiss
+
+#endif
@@ -530,6 +530,17 @@ class CodeSet
         }
     }
 
+    /// appends pointers to all contained CodeParts to parts
+    inline void getParts(std::vector<CodePart *> &parts)
+    {
+        for (std::list<CodePart> *list :
+             { &pindbgretreq_parts_, &inireq_parts_, &midopt_parts_, &appreq_parts_, &appopt_parts_, &appretreq_parts_ })
+        {
+            for (auto &part : *list)
+                parts.push_back(&part);
+        }
+    }
+
   private:
     static void writeCodeParts(std::string &code, const std::list<CodePart> &parts, bool required, RegisterSet &ignored,
                                bool intersect);
@@ -592,7 +603,7 @@ class CodeBlock
     };
 
   public:
-    inline CodeBlock(etiss::uint64 startindex) : startindex_(startindex) {}
+    inline CodeBlock(etiss::uint64 startindex) : startindex_(startindex), singleentry_(false) {}
     inline void reserve(int num) { lines_.reserve(num); }
     inline Line &get(unsigned index) { return lines_[index]; }
     inline Line &append(etiss::uint64 addr)
@@ -603,7 +614,38 @@ class CodeBlock
     inline unsigned length() const { return (unsigned)lines_.size(); }
     inline std::set<std::string> &fileglobalCode() { return fileglobal_code; }
     inline std::set<std::string> &functionglobalCode() { return functionglobal_code; }
+    /// code that is executed when the block returns after its last instruction
+    inline std::string &exitCode() { return exit_code; }
     void toCode(std::stringstream &out, const std::string &funcname, std::set<std::string> *fileglobalcode);
+    /**
+            @brief if true toCode emits the instructions as straight-line code that may only be entered at the start
+       index instead of a switch over all instruction addresses. entering at another address returns
+       ETISS_RETURNCODE_ILLEGALJUMP; such entries must be translated as separate blocks
+    */
+    inline void setSingleEntry(bool singleentry) { singleentry_ = singleentry; }
+    /**
+            @brief keeps the registers accessed with access + index + "]" (e.g. "*((RV32IMACFD*)cpu)->X[") in local
+       variables of type type for the whole block
+
+            @detail the registers are loaded at function entry and written back before every return, before the
+       block returns after its last instruction and before CodeParts that may observe or modify the cpu state (calls
+       with cpu, system or plugin_pointers). such CodeParts access the registers in memory and the local variables are
+       reloaded after them. must be called after all plugins finalized the block
+    */
+    void cacheRegisters(const std::string &access, const std::string &type, unsigned count);
+    /**
+            @brief defers constant stores to cpu->instructionPointer and constant cpu->cpuTime_ps updates to local
+       variables that are written to the cpu structure before every return, before the block returns after its last
+       instruction and before CodeParts that may observe the cpu state or access these fields otherwise. must be
+       called after all plugins finalized the block
+    */
+    void deferStateUpdates();
+    /**
+            @brief replaces the calls of system->dread and system->dwrite with ETISS_System_dread and
+       ETISS_System_dwrite that access the direct memory ranges of the system inline. must be called after all plugins
+       finalized the block
+    */
+    void useDirectMemory();
 
   private:
     std::vector<Line> lines_;
@@ -611,6 +653,8 @@ class CodeBlock
     etiss::uint64 endaddress_;
     std::set<std::string> fileglobal_code;
     std::set<std::string> functionglobal_code;
+    std::string exit_code;
+    bool singleentry_;
 };
 } // namespace etiss
 #endif
@@ -0,0 +1,111 @@
+/*
+
+        @copyright
+
+        <pre>
+
+        Copyright 2018 Infineon Technologies AG
+
+        This file is part of ETISS tool, see <https://github.com/tum-ei-eda/etiss>.
+
+        The initial version of this software has been created with the funding support by the German Federal
+        Ministry of Education and Research (BMBF) in the project EffektiV under grant 01IS13022.
+
+        Redistribution and use in source and binary forms, with or without modification, are permitted
+        provided that the following conditions are met:
+
+        1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+        the following disclaimer.
+
+        2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+        and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+        3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+        or promote products derived from this software without specific prior written permission.
+
+        THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+        WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+        PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+        DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+        PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+        HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+        NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+        POSSIBILITY OF SUCH DAMAGE.
+
+        </pre>
+
+        @author Chair of Electronic Design Automation, TUM
+
+        @version 0.1
+
+*/
+/**
+        @file
+
+        @brief timed wake-ups of coroutine plugins
+
+*/
+
+#ifndef ETISS_INCLUDE_EVENTQUEUE_H_
+#define ETISS_INCLUDE_EVENTQUEUE_H_
+
+#include "etiss/jit/types.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace etiss
+{
+
+class CoroutinePlugin;
+
+/**
+        @brief deadlines of event driven coroutine plugins (see CoroutinePlugin::isEventDriven) ordered by
+   ETISS_CPU::cpuTime_ps
+
+        @detail etiss::CPUCore::execute only executes an event driven plugin once the cpu time reached its deadline
+   instead of calling it before every block. each plugin has at most one pending wake-up; it is removed when the
+   plugin is executed and the plugin has to request the next one (CoroutinePlugin::scheduleAt). wake-ups may be
+   requested from other threads (e.g. etiss::InterruptHandler::setLine)
+*/
+class EventQueue
+{
+  public:
+    static const etiss::uint64 NEVER = (etiss::uint64)-1;
+
+    EventQueue();
+    /**
+            @brief sets the wake-up time of a plugin. replaces a pending wake-up of the same plugin. NEVER removes it
+    */
+    void schedule(CoroutinePlugin *plugin, etiss::uint64 time_ps);
+    /**
+            @brief removes all wake-ups
+    */
+    void clear();
+    /**
+            @brief earliest pending wake-up or NEVER. cheap enough to be checked before every block
+    */
+    inline etiss::uint64 next() const { return next_; }
+    /**
+            @brief location of next() that translated code may read (see etiss::Translation::setChainDeadline)
+    */
+    inline const volatile etiss::uint64 *nextLocation() const { return &next_; }
+    /**
+            @brief removes the plugins with a wake-up time <= time_ps and appends them to due in order of their
+   wake-up time
+    */
+    void pop(etiss::uint64 time_ps, std::vector<CoroutinePlugin *> &due);
+
+  private:
+    void updateNext();
+
+    std::mutex mu_;
+    std::multimap<etiss::uint64, CoroutinePlugin *> events_;
+    std::map<CoroutinePlugin *, std::multimap<etiss::uint64, CoroutinePlugin *>::iterator> pending_;
+    volatile etiss::uint64 next_; ///< written under mu_; aligned 64 bit reads don't tear on supported hosts
+};
+
+} // namespace etiss
+
+#endif
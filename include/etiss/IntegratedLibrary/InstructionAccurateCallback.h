@@ -44,32 +44,59 @@
 #define ETISS_PLUGIN_InstructionAccurateCallback_H_
 
 #include "etiss/Plugin.h"
+#include "etiss/fault/Injector.h"
 
 #include <fstream>
 
 namespace etiss
 {
 
+class VirtualStruct;
+
 namespace plugin
 {
 
 /**
-        writes the value of a field before each instruction
+        calls the fault injector of the cpu core (etiss::VirtualStruct::instructionAccurateCallback) before each
+   instruction.
 
+        with faults.compile_triggers the translated code checks the trigger table of the injector (see
+   etiss::fault::Injector::TriggerTable) and only calls the injector if one of its conditions holds. the table is
+   updated before every block and after every call of the injector; adding or removing triggers doesn't require a new
+   translation.
 */
-class InstructionAccurateCallback : public etiss::TranslationPlugin
+class InstructionAccurateCallback : public etiss::TranslationPlugin, public etiss::CoroutinePlugin
 {
   public:
+    struct Data
+    {
+        etiss::fault::Injector::TriggerTable table_; // must be first field to allow a pointer cast in translated code
+        InstructionAccurateCallback *this_;
+    };
+
     InstructionAccurateCallback();
     virtual ~InstructionAccurateCallback();
     virtual void initCodeBlock(etiss::CodeBlock &block) const;
     virtual void finalizeInstrSet(etiss::instr::ModedInstructionSet &) const;
+    virtual etiss::int32 execute();
+    virtual void *getPluginHandle();
 
   protected:
     virtual std::string _getPluginName() const;
 
   public:
     void call();
+
+  private:
+    /// returns true if translated code can read the fields of the trigger table relative to the cpu structure
+    bool useTriggerTable() const;
+    /// fills the trigger table again if the triggers changed since it was filled
+    void updateTriggerTable();
+
+    const bool compiletriggers_;
+    Data pluginData_;
+    bool tablevalid_;
+    uint64_t generation_; ///< trigger generation of the injector the table was filled for
 };
 
 } // namespace plugin
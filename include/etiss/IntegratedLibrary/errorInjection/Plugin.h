@@ -108,6 +108,11 @@ class BlockAccurateHandler : public etiss::CoroutinePlugin
     */
     virtual etiss::int32 execute();
 
+    /**
+            @brief only executed when the time of the next error passed (etiss.event_queue)
+    */
+    virtual bool isEventDriven() { return true; }
+
     /**
             @brief reads a file and adds the errors.
             @detail <pre>
@@ -137,6 +142,8 @@ class BlockAccurateHandler : public etiss::CoroutinePlugin
     virtual void cleanup();
 
   private:
+    void scheduleNext();
+
     ETISS_CPU *cpu;
     ETISS_System *system;
     CPUArch *arch;
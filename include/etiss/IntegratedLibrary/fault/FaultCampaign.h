@@ -0,0 +1,172 @@
+/*
+
+        @copyright
+
+        <pre>
+
+        Copyright 2018 Infineon Technologies AG
+
+        This file is part of ETISS tool, see <https://github.com/tum-ei-eda/etiss>.
+
+        The initial version of this software has been created with the funding support by the German Federal
+        Ministry of Education and Research (BMBF) in the project EffektiV under grant 01IS13022.
+
+        Redistribution and use in source and binary forms, with or without modification, are permitted
+        provided that the following conditions are met:
+
+        1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+        the following disclaimer.
+
+        2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+        and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+        3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+        or promote products derived from this software without specific prior written permission.
+
+        THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+        WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+        PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+        DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+        PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+        HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+        NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+        POSSIBILITY OF SUCH DAMAGE.
+
+        </pre>
+
+        @author Chair of Electronic Design Automation, TUM
+
+        @version 0.1
+
+*/
+/**
+        @file
+
+        @brief runs a fault injection campaign with forked worker processes
+
+        @detail the golden execution runs up to the earliest injection point of all faults. There the process forks a
+   golden reference run and afterwards one worker per fault (at most N at a time). Workers share the translated code
+   and the simulated memory of the fork point copy-on-write, apply exactly one fault and append one line per
+   experiment to the result file.
+
+*/
+
+#ifndef ETISS_PLUGIN_FAULT_FAULTCAMPAIGN_H_
+#define ETISS_PLUGIN_FAULT_FAULTCAMPAIGN_H_
+
+#include "etiss/Plugin.h"
+#include "etiss/fault/Fault.h"
+
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace etiss
+{
+
+namespace plugin
+{
+
+namespace fault
+{
+
+/**
+        @brief CoroutinePlugin that turns a simulation into a fault injection campaign.
+
+        @detail the faults of the xml file are NOT added to etiss::fault::Stressor in the main process; each worker
+   adds only its own fault. Trigger evaluation still depends on the injectors of the simulation (e.g. the
+   InstructionAccurateCallback plugin). Results are written as CSV with the columns
+   fault_id,fault_name,exit_code,divergence_ps,state_hash,result where the golden run is reported with id -1.
+   The divergence point is the first sampled cpu time at which the hash of the cpu state differs from the golden run.
+*/
+class FaultCampaign : public etiss::CoroutinePlugin
+{
+  public:
+    /**
+            @param xml fault definition file (see etiss::fault::parseXML)
+            @param result path of the result file. existing files are overwritten
+            @param workers maximum number of concurrently running workers
+            @param sample_ps interval (cpu time) between two compared state samples
+            @param max_samples maximum number of state samples recorded by the golden run
+            @param timeout_factor workers are stopped after timeout_factor times the remaining golden run time
+       (cpu time) or, if they stop advancing the cpu time, timeout_factor times the wall clock time of the golden
+       run (at least 10 s)
+    */
+    FaultCampaign(const std::string &xml, const std::string &result, unsigned workers, uint64_t sample_ps,
+                  uint64_t max_samples, unsigned timeout_factor);
+    virtual ~FaultCampaign();
+
+    virtual void init(ETISS_CPU *cpu, ETISS_System *system, CPUArch *arch);
+    virtual etiss::int32 execute();
+    virtual void executionEnd(int32_t code);
+
+  protected:
+    virtual std::string _getPluginName() const;
+
+  private:
+    struct Sample
+    {
+        uint64_t time_ps;
+        uint64_t hash;
+    };
+    /// golden run results shared with all workers (MAP_SHARED)
+    struct Golden
+    {
+        uint64_t end_ps;
+        uint64_t hash;
+        int32_t code;
+        uint32_t reserved;
+        uint64_t count;
+        Sample samples[1];
+    };
+    enum Role
+    {
+        MAIN,
+        GOLDEN,
+        WORKER
+    };
+
+    uint64_t hashState() const;
+    /// forks the golden run and all workers. returns in the main process once all experiments have finished and
+    /// in every forked child process
+    void runCampaign();
+    void sample();
+    void reap(bool block);
+    void writeResult(const etiss::fault::Fault *fault, const std::string &code, const std::string &divergence,
+                     const std::string &hash, const char *result);
+
+    const std::string xml_;
+    const std::string result_;
+    const unsigned workers_;
+    const uint64_t sample_ps_;
+    const uint64_t max_samples_;
+    const unsigned timeout_factor_;
+
+    std::vector<etiss::fault::Fault> faults_;
+    uint64_t fork_ps_;
+    uint64_t last_ps_;
+    Role role_;
+    const etiss::fault::Fault *fault_;
+    size_t cpusize_;
+    int fd_;
+    Golden *golden_;
+    size_t golden_size_;
+    uint64_t next_sample_;
+    uint64_t sample_index_;
+    uint64_t divergence_ps_;
+    bool diverged_;
+    uint64_t timeout_ps_;
+    unsigned timeout_s_; ///< wall clock limit of a worker (alarm); 0 if disabled
+    bool timedout_;
+    std::map<pid_t, const etiss::fault::Fault *> running_;
+};
+
+} // namespace fault
+
+} // namespace plugin
+
+} // namespace etiss
+
+#endif
@@ -97,6 +97,16 @@ class InterruptHandler : public etiss::CoroutinePlugin
             @return etiss::RETURNCODE::INTERRUPT if an interrupt should occur
     */
     virtual etiss::int32 execute();
+    /**
+            @brief edge triggered handlers are only executed when the next pending change of a line is due
+    */
+    virtual bool isEventDriven();
+    /**
+            @brief saves the pending line changes and the raised edge triggered lines for CPUCore::checkpoint. the
+       InterruptVector itself is part of the cpu structure
+    */
+    virtual void saveState(std::vector<etiss::uint8> &state);
+    virtual void restoreState(const std::vector<etiss::uint8> &state);
     virtual std::string _getPluginName() const;
 
   protected:
@@ -91,6 +91,25 @@ class JIT
             @brief clean up handled returned by etiss::JIT::translate
     */
     virtual void free(void *handle) = 0;
+    /**
+            @brief returns true if translate/getFunction/free of this instance may be called concurrently from
+       multiple threads (e.g. by background compilation in etiss::Translation). calls to an instance that is not
+       thread safe are serialized
+    */
+    virtual bool isThreadSafe() { return false; }
+    /**
+            @brief announces code (e.g. the common includes of an architecture) that every code string passed to
+       translate by the caller starts with. a JIT may compile it once (e.g. as precompiled header) and only compile
+       the remaining code of later translations. may be called with several different preludes
+    */
+    virtual void setPrelude(const std::string &prelude) {}
+    /**
+            @brief returns true if calls in tail position of the translated code are compiled as jumps. block chaining
+       (see etiss/jit/BlockChain.h) is only used if this is true, otherwise every chained block would add a stack
+       frame
+            @param debug value of the debug parameter passed to translate
+    */
+    virtual bool optimizesTailCalls(bool debug) { return false; }
     /**
             @brief returns the JIT instance name previously passed to the constructor
     */
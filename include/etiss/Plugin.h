@@ -56,6 +56,7 @@
 
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "etiss/ClassDefs.h"
 #include "etiss/jit/CPU.h"
@@ -213,6 +214,15 @@ class Plugin : public etiss::ToString
        the CPUCore
     */
     virtual inline void removedFromCPUCore(etiss::CPUCore *core) {}
+    /**
+        saves the state of the plugin that influences the simulation for CPUCore::checkpoint. the default
+       implementation saves nothing
+    */
+    virtual inline void saveState(std::vector<etiss::uint8> &state) {}
+    /**
+        restores a state saved by saveState for CPUCore::restore
+    */
+    virtual inline void restoreState(const std::vector<etiss::uint8> &state) {}
 
   private:
     unsigned type_;
@@ -297,6 +307,8 @@ class TranslationPlugin : virtual public Plugin
 */
 class CoroutinePlugin : virtual public Plugin
 {
+    friend class CPUCore;
+
   public:
     CoroutinePlugin();
     virtual ~CoroutinePlugin();
@@ -314,6 +326,22 @@ class CoroutinePlugin : virtual public Plugin
      *        which have an flag that must be set to execute.
      */
     virtual bool isActive() { return true; }
+    /**
+     * \brief if true the plugin is not called before every block but only once ETISS_CPU::cpuTime_ps reached the
+     *        time passed to scheduleAt (see etiss::EventQueue; requires etiss.event_queue=true). the plugin is
+     *        called once when the execution starts. execute() must request its next wake-up; it must still work
+     *        if it is called before every block (e.g. etiss.event_queue=false)
+     */
+    virtual bool isEventDriven() { return false; }
+    /**
+     * \brief requests a call of execute() once ETISS_CPU::cpuTime_ps >= time_ps. replaces a previous request;
+     *        EventQueue::NEVER removes it. may be called from other threads. ignored if the plugin is not event
+     *        driven or not executed by a CPUCore
+     */
+    void scheduleAt(etiss::uint64 time_ps);
+
+  private:
+    etiss::EventQueue *eventqueue_; ///< set by CPUCore::execute for event driven plugins
 };
 
 /**
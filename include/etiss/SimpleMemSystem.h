@@ -62,9 +62,13 @@
 namespace etiss
 {
 
+struct MemSegmentCheckpoint;
+
 class MemSegment
 {
     bool self_allocated_{ false };
+    size_t mapped_size_{ 0 }; ///< size of the mapping if the memory was allocated with mmap
+    MemSegmentCheckpoint *checkpoint_{ nullptr };
 
   public:
     enum access_t {
@@ -88,26 +92,48 @@ class MemSegment
     const etiss::uint64 size_;
     access_t mode_;
 
+    /**
+            @param mapped allocate the memory with anonymous demand-zero pages (mmap) instead of new[] so that only
+       touched pages occupy host memory. falls back to new[] if mmap isn't available
+    */
     MemSegment(etiss::uint64 start_addr, etiss::uint64 size, access_t mode, const std::string name,
-               etiss::uint8 *mem = nullptr)
+               etiss::uint8 *mem = nullptr, bool mapped = false)
         : name_(name), start_addr_(start_addr), end_addr_(start_addr + size - 1), size_(size), mode_(mode)
     {
         if (mem)
         { // use reserved memory
             mem_ = mem;
         }
-        else
+        else if (!mapped || !allocate_mapped())
         {
             mem_ = new etiss::uint8[size];
             self_allocated_ = true;
         }
     }
 
-    virtual ~MemSegment(void)
-    {
-        if (self_allocated_ == true)
-            delete[] mem_;
-    }
+    virtual ~MemSegment(void);
+
+    /**
+            @brief maps the whole pages of [file_offset, file_offset + file_size_bytes) of a file copy-on-write
+       (MAP_PRIVATE) at offset of the segment. writes of the simulation don't change the file
+            @return number of mapped bytes from the start of the range; the caller must load the remaining bytes. 0 if
+       the segment wasn't allocated with mmap or if offset or file_offset isn't page aligned
+    */
+    size_t map_file(const std::string &file, size_t offset, etiss::uint64 file_offset, size_t file_size_bytes);
+
+    /**
+            @brief saves the content of the segment; replaces a previous checkpoint. memory allocated with mmap is
+       saved copy-on-write: the pages are write protected and a page is copied on its first write after the
+       checkpoint or a restore. other memory is copied immediately
+    */
+    void checkpoint();
+    /**
+            @brief restores the content saved by checkpoint(). the checkpoint stays valid for further restores
+            @return number of restored bytes
+    */
+    size_t restore();
+    /// drops the checkpoint and removes the write protection
+    void discard_checkpoint();
 
     void load(const void *data, size_t offset, size_t file_size_bytes)
     {
@@ -130,6 +156,9 @@ class MemSegment
         }
         return false;
     }
+
+  private:
+    bool allocate_mapped();
 };
 
 /**
@@ -145,6 +174,15 @@ class SimpleMemSystem : public System
         for (auto &mseg : msegs_)
             mseg.reset();
     }
+
+    /**
+            @brief saves the memory segments; replaces a previous checkpoint. segments allocated with
+       simple_mem_system.mmap are saved copy-on-write (see MemSegment::checkpoint). use together with
+       CPUCore::checkpoint
+    */
+    void checkpoint();
+    /// restores the memory segments saved by checkpoint()
+    void restore();
     // memory access
     etiss::int32 iread(ETISS_CPU *cpu, etiss::uint64 addr, etiss::uint32 len);
     etiss::int32 iwrite(ETISS_CPU *cpu, etiss::uint64 addr, etiss::uint8 *buf, etiss::uint32 len);
@@ -156,11 +194,16 @@ class SimpleMemSystem : public System
     // sync time
     void syncTime(ETISS_CPU *cpu);
 
+    /// publishes the memory segments for direct access unless data bus accesses are traced
+    const ETISS_DMIRange *getDMIRanges(etiss::uint32 &count);
+
     void init_memory();
     void load_elf();
     void load_segments(void);
     etiss::uint64 get_startaddr(void) { return (start_addr_); }
     void add_memsegment(std::unique_ptr<MemSegment>& mseg, const void *raw_data, size_t file_size_bytes);
+    /// @return [start,end) address ranges of the executable segments loaded by load_elf
+    const std::vector<std::pair<etiss::uint64, etiss::uint64>> &getExecutableRanges() const { return executable_ranges_; }
 
   private:
     std::vector<std::unique_ptr<MemSegment>> msegs_{};
@@ -168,7 +211,22 @@ class SimpleMemSystem : public System
     template <bool write>
     etiss::int32 dbus_access(ETISS_CPU *cpu, etiss::uint64 addr, etiss::uint8 *buf, etiss::uint32 len);
 
+    /// sorts the segments by start address and rebuilds the lookup of find_mseg
+    void index_memsegments();
+    /// @return the segment that contains [addr,addr+len) or nullptr; same result as a linear search of msegs_
+    MemSegment *find_mseg(etiss::uint64 addr, etiss::uint32 len);
+
+    /// segment (index + 1) of each page between mseg_base_ and the end of the last segment; 0 if there is none
+    /// and MSEG_PAGE_SHARED if the page belongs to several segments
+    std::vector<etiss::uint32> mseg_pages_{};
+    etiss::uint64 mseg_base_{ 0 };
+    unsigned mseg_pagebits_{ 0 };
+    std::vector<etiss::uint64> mseg_starts_{}; ///< start addresses of msegs_ for a binary search in shared pages
+    bool msegs_overlap_{ false };              ///< overlapping segments require a linear search
+
     etiss::uint64 start_addr_{ 0 };
+    std::vector<std::pair<etiss::uint64, etiss::uint64>> executable_ranges_{};
+    std::vector<ETISS_DMIRange> dmi_ranges_{};
 
     struct find_fitting_mseg {
         find_fitting_mseg(uint64 addr, uint64 size) : addr(addr), size(size) {}
@@ -181,6 +239,7 @@ class SimpleMemSystem : public System
     bool print_dbus_access_;
     bool print_dbgbus_access_;
     bool print_to_file_;
+    bool mmap_; ///< allocate segments with mmap and map image files (see MemSegment::map_file)
 
     bool error_on_seg_mismatch_;
 
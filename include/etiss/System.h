@@ -212,6 +212,26 @@ class System
      * should be performed.
      */
     virtual void syncTime(ETISS_CPU *cpu) = 0;
+
+    /**
+     * @brief Direct memory interface.
+     *
+     * @details Returns host memory of plain ram that translated code may
+     * access directly instead of calling dread() or dwrite() (only with
+     * jit.direct_memory). Accesses to these ranges must not require any side
+     * effect like tracing, time updates or access checks. The ranges are read
+     * once by etiss::wrap() and must remain valid as long as the wrapped
+     * system is used.
+     *
+     * @param count Receives the number of ranges.
+     *
+     * @return The ranges or nullptr if there are none.
+     */
+    virtual const ETISS_DMIRange *getDMIRanges(etiss::uint32 &count)
+    {
+        count = 0;
+        return nullptr;
+    }
 };
 
 /**
@@ -43,13 +43,22 @@
 #ifndef ETISS_INCLUDE_TRANSLATION_H
 #define ETISS_INCLUDE_TRANSLATION_H
 
+#include "etiss/BlockLookupTable.h"
 #include "etiss/CPUArch.h"
+#include "etiss/CodePageTracker.h"
 #include "etiss/CodePart.h"
 #include "etiss/Instruction.h"
 #include "etiss/JIT.h"
+#include "etiss/jit/BlockChain.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace etiss
 {
@@ -64,14 +73,52 @@ class BlockLink
   public:
     const etiss::uint64 start;          ///< start instruction index
     const etiss::uint64 end;            ///< end instruction index (excluded)
-    BlockLink *next;                    ///< next block; ONLY MODIFY WITH updateRef
-    BlockLink *branch;                  ///< last branch block; ONLY MODIFY WITH updateRef
+    BlockLink *next;                    ///< next block; ONLY MODIFY WITH setNext
+    BlockLink *branch;                  ///< last branch block; ONLY MODIFY WITH setBranch
     unsigned refcount;                  ///< number of references to this instance; DO NOT MODIFY
-    const ExecBlockCall execBlock;      ///< function pointer
+    ExecBlockCall execBlock;            ///< function pointer; may be replaced by Translation::processCompiledBlocks
     bool valid;                         ///< true if the associated function implements current code
-    const std::shared_ptr<void> jitlib; ///< library of the associated function
+    std::shared_ptr<void> jitlib;       ///< library of the associated function; replaced together with execBlock
+    etiss::uint32 execcount;            ///< number of executions; used for tiered compilation and traces
+    etiss::uint32 nextcount;            ///< number of transitions to next; reset if next changes
+    etiss::uint32 branchcount;          ///< number of transitions to branch; reset if branch changes
+    ETISS_BlockChain *chain;            ///< chaining slots in the compiled code; 0 if chaining is disabled
+    etiss::uint64 pma;                  ///< physical address of start; only checked with physical tags
+    size_t size;                        ///< bytes charged to the code cache budget
+    bool referenced;                    ///< clock bit of the code cache eviction; set on execution
+    bool pretranslated;                 ///< translated by Translation::pretranslate; may not match jump targets
+    etiss::uint64 entryend;             ///< [start,entryend) may be entered; start + 1 for single entry blocks
     BlockLink(etiss::uint64 start, etiss::uint64 end, ExecBlockCall execBlock, std::shared_ptr<void> lib);
     ~BlockLink();
+    /**
+            @brief change the next block and the corresponding chaining slot
+            @param bl may be 0
+    */
+    inline void setNext(BlockLink *bl)
+    {
+        if (next != bl)
+            nextcount = 0;
+        updateRef(next, bl);
+        if (chain != 0)
+            setChainSlot(chain->next, next);
+    }
+    /**
+            @brief change the branch block and the corresponding chaining slot
+            @param bl may be 0
+    */
+    inline void setBranch(BlockLink *bl)
+    {
+        if (branch != bl)
+            branchcount = 0;
+        updateRef(branch, bl);
+        if (chain != 0)
+            setChainSlot(chain->branch, branch);
+    }
+    /**
+            @brief points a chaining slot to a block. the slot references the function pointer and validity flag of
+       the block; thus a block may only be referenced by a slot while it is referenced by next/branch
+    */
+    static void setChainSlot(ETISS_BlockChainSlot &slot, BlockLink *bl);
     /**
             @brief increase reference count to a BlockLink
             @param link MAY NOT BE 0
@@ -148,6 +195,87 @@ class Translation
     etiss::instr::ModedInstructionSet *mis_;
 
     std::unordered_map<etiss::uint64, std::list<BlockLink *>> blockmap_;
+    /// blocks of blockmap_ by exact start index; entries are removed together with the blockmap_ reference
+    BlockLookupTable<BlockLink> blocktable_;
+
+    /// maximum number of consecutive blocks compiled into one library (jit.batch_size)
+    size_t batchsize_;
+    /// executions after which a block compiled by fastjit_ is recompiled by jit_ (jit.tiering.threshold)
+    etiss::uint32 tierthreshold_;
+    size_t promotedcount_;
+
+    /**
+            asynchronous compilation (jit.async.threads > 0): new blocks are compiled by fastjit_ on the
+            simulation thread and recompiled by jit_ on worker threads. finished jobs are installed by
+            processCompiledBlocks. with tiered compilation (jit.tiering.threshold > 0) the recompilation
+            only starts once a block is hot
+    */
+    struct CompileJob;
+    std::shared_ptr<etiss::JIT> fastjit_;
+    std::vector<std::thread> workers_;
+    std::mutex jobmu_;
+    std::condition_variable jobcv_;
+    std::deque<CompileJob *> jobs_;          ///< pending jobs; protected by jobmu_
+    std::vector<CompileJob *> finishedjobs_; ///< compiled jobs; protected by jobmu_
+    std::atomic<bool> finishedpending_;      ///< true if finishedjobs_ may be non empty
+    bool stopworkers_;
+    std::shared_ptr<std::mutex> jitmu_; ///< serializes calls to jit_ if it is not thread safe
+    /// direct chaining of blocks (jit.chaining.budget > 0)
+    etiss::int32 chainbudget_;
+    etiss::int32 chainbudgetmax_;
+    void *chainlast_;
+    const volatile etiss::uint64 *chaindeadline_; ///< chains stop once ETISS_CPU::cpuTime_ps reaches this time
+    /**
+            physically tagged blocks (cores with MMU): blocks are looked up by instruction index (virtual address)
+            and only used if the instruction index maps to the same physical address as during translation. thus
+            blocks of different address spaces coexist and are reused after context switches. blocks don't cross
+            page boundaries (pagebits_) to make a single physical address sufficient
+    */
+    bool physicaltags_;
+    unsigned pagebits_;
+    etiss::uint64 fetchpma_; ///< physical address of the next requested instruction index
+    /// records writes to translated code (jit.track_code_writes); may be nullptr
+    etiss::CodePageTracker *codetracker_;
+    /**
+            trace formation (jit.trace.threshold > 0): once a block has been executed jit.trace.threshold times the
+            path along its most frequently taken next/branch links is recompiled by jit_ as one superblock that
+            replaces the function of the first block. the superblock calls the functions of the path blocks
+            (compiled into the same library) and returns at the first side exit
+    */
+    etiss::uint32 tracethreshold_;
+    size_t tracemaxblocks_;
+    size_t tracecount_;
+    /// superblock head -> blocks whose code is contained in the superblock (all referenced)
+    std::unordered_map<BlockLink *, std::vector<BlockLink *>> traces_;
+    /**
+            code cache budget (jit.cache.max_blocks, jit.cache.max_bytes): blocks are evicted with the clock
+            algorithm once the number of blocks or their (generated code) size exceeds the budget
+    */
+    size_t maxblocks_;
+    etiss::uint64 maxbytes_;
+    etiss::uint64 cachedbytes_;
+    std::vector<BlockLink *> clock_; ///< cached blocks (referenced); empty if there is no budget
+    size_t clockhand_;
+    std::unordered_set<etiss::uint64> evicted_; ///< start indices of evicted blocks
+    size_t evictedcount_;
+    size_t retranslatedcount_;
+    /// tiered compilation: recompilation jobs of blocks that didn't reach the threshold yet
+    std::unordered_map<BlockLink *, CompileJob *> coldjobs_;
+    /// register caching in local variables of a block (see etiss::CPUArch::getCachedRegisters)
+    bool cacheregisters_;
+    std::string regaccess_;
+    std::string regtype_;
+    unsigned regcount_;
+    bool deferstate_; ///< defer program counter and time updates to block exits (see CodeBlock::deferStateUpdates)
+    bool singleentry_; ///< straight-line blocks; mid-block entries get own blocks (see CodeBlock::setSingleEntry)
+    bool directmemory_; ///< inline accesses to direct memory ranges of the system (see CodeBlock::useDirectMemory)
+    /// file global code that starts every generated code string (see etiss::JIT::setPrelude)
+    std::string prelude_;
+    std::set<std::string> preludeparts_;
+    /// compilation statistics of all jit calls (also of background threads)
+    std::atomic<etiss::uint64> compiledlibs_;
+    std::atomic<etiss::uint64> compiledblocks_;
+    std::atomic<etiss::uint64> compilens_; ///< total compile time in nanoseconds
 #if ETISS_TRANSLATOR_STAT
     etiss::uint64 next_count_;
     etiss::uint64 branch_count_;
@@ -167,11 +295,12 @@ class Translation
         if (prev != 0)
         {
             BlockLink *bl = prev->next;
-            if (instructionindex >= prev->end && bl != 0 && bl->end > instructionindex)
+            if (instructionindex >= prev->end && bl != 0 && bl->entryend > instructionindex)
             { // ->next MUST always start immediately after the current block since it is not checked here
-                // check if block is invalid
-                if (bl->valid)
+                // check if block is invalid or maps to other physical memory
+                if (bl->valid && matchesPhysical(bl, instructionindex, fetchpma_))
                 {
+                    prev->nextcount++;
 #if ETISS_TRANSLATOR_STAT
                     next_count_++;
 #endif
@@ -179,15 +308,16 @@ class Translation
                 }
                 else
                 {
-                    BlockLink::updateRef(prev->next, 0);
+                    prev->setNext(0);
                 }
             }
             bl = prev->branch;
-            if (bl != 0 && bl->start <= instructionindex && bl->end > instructionindex)
+            if (bl != 0 && bl->start <= instructionindex && bl->entryend > instructionindex)
             {
-                // check if block is invalid
-                if (bl->valid)
+                // check if block is invalid or maps to other physical memory
+                if (bl->valid && matchesPhysical(bl, instructionindex, fetchpma_))
                 { // check
+                    prev->branchcount++;
 #if ETISS_TRANSLATOR_STAT
                     branch_count_++;
 #endif
@@ -195,7 +325,7 @@ class Translation
                 }
                 else
                 {
-                    BlockLink::updateRef(prev->branch, 0);
+                    prev->setBranch(0);
                 }
             }
         }
@@ -209,10 +339,164 @@ class Translation
 
     etiss::int32 translateBlock(CodeBlock &cb);
 
+    /**
+            @brief replaces the function of blocks whose background compilation finished. must be called by the
+       simulation thread while no block is executed. does nothing if asynchronous compilation is disabled
+    */
+    inline void processCompiledBlocks()
+    {
+        if (unlikely(finishedpending_.load(std::memory_order_relaxed)))
+            installCompiledBlocks();
+    }
+
+    /**
+            @brief must be called before a block is executed. limits the number of blocks that execute without
+       returning to the simulation loop
+    */
+    inline void startChain(BlockLink *bl)
+    {
+        chainbudget_ = chainbudgetmax_;
+        chainlast_ = bl;
+    }
+    /**
+            @brief chained blocks return to the simulation loop once ETISS_CPU::cpuTime_ps reached the value at
+       deadline (e.g. etiss::EventQueue::nextLocation). the value is read before each chained call, so it may change
+       while a chain runs. must be set before blocks are translated
+    */
+    void setChainDeadline(const volatile etiss::uint64 *deadline) { chaindeadline_ = deadline; }
+    /**
+            @brief returns the last block executed by a chain started with startChain. it is the block to
+       pass as prev to getBlockFast
+    */
+    inline BlockLink *endChain() { return (BlockLink *)chainlast_; }
+    /**
+            @brief enables physically tagged blocks (see physicaltags_). must be called before the first block is
+       requested
+            @param pagebits log2 of the (smallest) page size of the MMU
+    */
+    void enablePhysicalTags(unsigned pagebits)
+    {
+        physicaltags_ = true;
+        pagebits_ = pagebits;
+    }
+    /// sets the physical address of the instruction index passed to the next getBlockFast call
+    inline void setFetchAddress(etiss::uint64 pma) { fetchpma_ = pma; }
+    /// disables chaining of blocks translated afterwards (e.g. if each instruction fetch must be checked by a MMU)
+    void disableChaining() { chainbudgetmax_ = 1; }
+
+    /**
+            @brief counts an execution of a block. with tiered compilation a block that reaches the threshold is
+       recompiled by the optimizing jit (in the background if worker threads are available). with trace formation
+       a hot block is recompiled as superblock together with its frequently executed successors
+    */
+    inline void countExecution(BlockLink *bl)
+    {
+        bl->referenced = true;
+        ++bl->execcount;
+        if (unlikely(bl->execcount == tierthreshold_ && tierthreshold_ != 0)) // execcount wraps around
+            promote(bl);
+        if (unlikely(bl->execcount == tracethreshold_ && tracethreshold_ != 0))
+            formTrace(bl);
+    }
+
     void unloadBlocks(etiss::uint64 startindex = 0, etiss::uint64 endindex = ((etiss::uint64)((etiss::int64)-1)));
 
+    /**
+            @brief sets the tracker that is informed about the address ranges of translated blocks. if set,
+       invalidateWrittenCode only unloads the blocks of written memory regions and a write to code ends the current
+       chain after the writing block
+    */
+    void setCodeTracker(etiss::CodePageTracker *tracker)
+    {
+        codetracker_ = tracker;
+        if (tracker)
+            tracker->setChainBudget(&chainbudget_);
+    }
+    /// @return true if a CodePageTracker has been set
+    bool tracksCodeWrites() const { return codetracker_ != nullptr; }
+    /**
+            @brief unloads the blocks of all memory regions that have been written since the last call. unloads all
+       blocks if no tracker has been set
+    */
+    void invalidateWrittenCode();
+
+    /**
+            @brief translates the code of the given [start,end) ranges ahead of execution by a linear sweep and
+       compiles it with worker threads (jit.aot.threads) in libraries of jit.aot.batch_size blocks. with a persistent
+       jit cache (e.g. jit.gcc.cache_path) the compiled libraries are reused by later runs of the same program.
+       must be called after init and before the first block is requested
+    */
+    void pretranslate(const std::vector<std::pair<etiss::uint64, etiss::uint64>> &ranges);
+
     std::string disasm(uint8_t *buf, unsigned len, int &append);
 
+  private:
+    /// @return true if physical tags are disabled or instructionindex of bl maps to pma
+    inline bool matchesPhysical(BlockLink *bl, etiss::uint64 instructionindex, etiss::uint64 pma) const
+    {
+        return !physicaltags_ || bl->pma + (instructionindex - bl->start) == pma;
+    }
+    /**
+            @brief returns a valid translated block containing instructionindex or nullptr. doesn't modify the block
+       cache
+            @param pma physical address of instructionindex; only checked with physical tags
+    */
+    BlockLink *findBlock(const etiss::uint64 &instructionindex, etiss::uint64 pma);
+    /**
+            @brief translates the block starting at instructionindex and appends its function to code
+            @param fileglobalcode file global code that has already been written to code
+            @param body if true the function is static and doesn't continue with linked blocks (part of a superblock)
+    */
+    etiss::int32 generateBlockCode(const etiss::uint64 &instructionindex, etiss::uint64 &endindex,
+                                   std::string &functionname, std::stringstream &code,
+                                   std::set<std::string> &fileglobalcode, bool body = false);
+    /// writes the prelude to code and marks its parts as written in fileglobalcode
+    void beginCode(std::stringstream &code, std::set<std::string> &fileglobalcode);
+    /// calls jit->translate and records the compile latency of the library of blocks functions
+    void *compile(etiss::JIT *jit, const std::string &code, size_t blocks, const std::set<std::string> &headers,
+                  const std::set<std::string> &libloc, const std::set<std::string> &libs, std::string &error,
+                  bool debug);
+    /// writes the exported chaining function of a block whose code has been written as functionname + "_body"
+    static void writeChainFunction(std::stringstream &code, const std::string &functionname);
+    /// headers, libraries and debug flag passed to the jit
+    void getJITParameters(std::set<std::string> &headers, std::set<std::string> &libloc,
+                          std::set<std::string> &libs, bool &debug);
+    /**
+            @brief creates a block for a function of a compiled library and adds it to the block cache
+            @param pma physical address of start; only used with physical tags
+            @param size generated code size of the block; charged to the code cache budget
+    */
+    BlockLink *addBlock(std::shared_ptr<etiss::JIT> jit, std::shared_ptr<void> lib, const std::string &functionname,
+                        etiss::uint64 start, etiss::uint64 end, etiss::uint64 pma, size_t size);
+    /// @return true if the code cache budget doesn't allow another block
+    inline bool cacheExceeded() const
+    {
+        return (maxblocks_ != 0 && clock_.size() >= maxblocks_) || (maxbytes_ != 0 && cachedbytes_ >= maxbytes_);
+    }
+    /// evicts blocks until the code cache is below its budget
+    void evictBlocks();
+    /// invalidates a block and removes it from the block cache
+    void removeBlock(BlockLink *bl);
+    /// releases the references of the code cache
+    void clearClock();
+    /// connects the chaining variable of a new block function with the block
+    void initChain(BlockLink *bl, ETISS_BlockChain *chain);
+    void installCompiledBlocks();
+    void promote(BlockLink *bl);
+    /// compiles the job in the background or (if there are no worker threads) immediately
+    void submitJob(CompileJob *job);
+    void formTrace(BlockLink *head);
+    /// releases superblocks whose blocks have been invalidated (or all superblocks)
+    void dropTraces(bool all);
+    void queueJob(CompileJob *job);
+    void compileJob(CompileJob *job);
+    /// deletes recompilation jobs of tiered compilation whose blocks are all invalid (or all jobs)
+    void dropColdJobs(bool all);
+    void compileWorker();
+    void stopWorkers();
+    /// wraps a library handle returned by jit for cleanup
+    std::shared_ptr<void> wrapLibrary(std::shared_ptr<etiss::JIT> jit, void *handle);
+
   private:
     /// unique id used to generate unique function names across translation instances
     const uint64_t id;
@@ -236,6 +236,9 @@ class VirtualStruct : public std::enable_shared_from_this<VirtualStruct>, public
         void signalWrite(); ///< this function should be called if the listener flag is set and the field changed
                             ///< without using the write() function. write() will automatically call this function if
                             ///< the listener flag is set.
+        /// returns a pointer to the unsigned integer of width_ bytes that read() returns or nullptr if there is no
+        /// such storage. allows translated code to read the field directly (see VirtualStruct::getFieldOffset)
+        virtual const void *getPointer() const;
       protected:            // read write implementation
         /// override this function to implement reads in case of AccessMode::VIRTUAL / AccessMode::PREFER_LAMBDA
         virtual uint64_t _read() const;
@@ -363,6 +366,8 @@ class VirtualStruct : public std::enable_shared_from_this<VirtualStruct>, public
 
     virtual bool acceleratedTrigger(const etiss::fault::Trigger &, int32_t fault_id);
 
+    virtual bool getFieldOffset(const std::string &field, uint64_t &offset, uint64_t &width);
+
   protected: // inherited from etiss::fault::Injector
     virtual void *fastFieldAccessPtr(const std::string &name, std::string &errormsg);
     virtual bool readField(void *fastfieldaccessptr, uint64_t &val, std::string &errormsg);
@@ -155,6 +155,13 @@ class Injector
 
     virtual bool acceleratedTrigger(const etiss::fault::Trigger &, int32_t fault_id);
 
+    /**
+        @return true if the value of a field is stored in the structure that translated code accesses as "cpu".
+       offset is set relative to that structure and width to the width in bytes (1, 2, 4 or 8) of the unsigned integer
+       that readField() returns. default implementation returns false
+    */
+    virtual bool getFieldOffset(const std::string &field, uint64_t &offset, uint64_t &width);
+
   public: // static
     /**
     @param injectorPath the full path/name to/off an injector. in case of using ETISS/VirtualStruct please have a look
@@ -179,9 +186,55 @@ class Injector
     std::list<std::pair<Trigger, int32_t>> pending_triggers; ///> Triggers which were just added
     std::list<std::pair<Trigger, int32_t>> unknown_triggers; ///> Triggers to look at in callbacks
     /// TODO specialized lists. e.g. time triggers should be sorted and only the earliest time should be checked
+    volatile uint64_t trigger_generation;
+    std::list<std::pair<Trigger, int32_t>> checkpoint_triggers; ///> Triggers saved by checkpointTriggers()
 
   public: // interface fot stressor
     void addTrigger(const Trigger &t, int32_t fault_id);
+
+  public: // interface for translated code
+    /**
+        thresholds of the triggers of an injector. translated code reads the table from memory and only calls the
+       callback functions if one of its conditions holds; changed triggers thus don't need a new translation. all
+       members are 64 bit wide so that C code can declare the same layout (see
+       etiss::plugin::InstructionAccurateCallback)
+    */
+    struct TriggerTable
+    {
+        static const unsigned MAX_FIELDS = 8;
+        uint64_t always;  ///> nonzero if a trigger can only be checked by the callback functions
+        uint64_t time_ps; ///> earliest time of the TIME triggers. UINT64_MAX if there is none
+        uint64_t fields;  ///> number of used entries of field
+        struct
+        {
+            uint64_t offset; ///> see getFieldOffset()
+            uint64_t width;
+            uint64_t value;
+        } field[MAX_FIELDS]; ///> VARIABLEVALUE triggers fire if the field equals value
+    };
+    /**
+        fills the table with the conditions under which one of the triggers of this injector may fire. triggers
+       that cannot be expressed in the table (e.g. unresolved TIMERELATIVE triggers) set TriggerTable::always
+    */
+    void getTriggerTable(TriggerTable &table);
+    /**
+        @return a counter that changes whenever triggers are added or removed. a table filled by getTriggerTable()
+       is outdated once this value changes
+    */
+    uint64_t getTriggerGeneration() const { return trigger_generation; }
+
+  public: // checkpoints (see etiss::CPUCore::checkpoint)
+    /**
+        saves the triggers that have not fired yet including the count of counter triggers. replaces a previous
+       checkpoint
+        @attention MUST NOT be called during the callback functions
+    */
+    void checkpointTriggers();
+    /**
+        restores the triggers saved by checkpointTriggers(). triggers added after the checkpoint are dropped
+        @attention MUST NOT be called during the callback functions
+    */
+    void restoreTriggers();
 };
 
 } // namespace fault
@@ -174,6 +174,13 @@ class MMU
 
     virtual int32_t GetPid(uint64_t control_reg_val_) { return 0; }
 
+    /**
+     * @brief Number of page offset bits (log2 of the smallest page size) as
+     *		defined by the PTE format
+     *
+     */
+    uint32_t GetPageOffsetBits() const;
+
     bool cache_flush_pending;
 
   protected:
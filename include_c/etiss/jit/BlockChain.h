@@ -0,0 +1,128 @@
+/**
+
+        @copyright
+
+        <pre>
+
+        Copyright 2018 Infineon Technologies AG
+
+        This file is part of ETISS tool, see <https://github.com/tum-ei-eda/etiss>.
+
+        The initial version of this software has been created with the funding support by the German Federal
+        Ministry of Education and Research (BMBF) in the project EffektiV under grant 01IS13022.
+
+        Redistribution and use in source and binary forms, with or without modification, are permitted
+        provided that the following conditions are met:
+
+        1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+        the following disclaimer.
+
+        2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+        and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+        3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+        or promote products derived from this software without specific prior written permission.
+
+        THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+        WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+        PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+        DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+        PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+        HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+        NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+        POSSIBILITY OF SUCH DAMAGE.
+
+        </pre>
+
+        @author Chair of Electronic Design Automation, TUM
+
+        @version 0.1
+
+*/
+/**
+        @file
+
+        @brief successor slots for direct chaining of translated blocks
+
+        @detail if chaining is enabled (jit.chaining.budget > 0) etiss::Translation emits a wrapper for each block
+   function that calls the successor block directly if the instruction pointer after the block lies within the
+   next/branch successor that the simulator linked to the block. the slots mirror etiss::BlockLink::next and
+   etiss::BlockLink::branch and are only written by etiss::Translation. the successor is called in tail position;
+   chaining is only enabled if the JIT compiles such calls as jumps (etiss::JIT::optimizesTailCalls). blocks entered
+   through a chain are not counted by etiss::Translation::countExecution.
+
+*/
+
+#ifndef ETISS_INCLUDE_JIT_BLOCKCHAIN_H_
+#define ETISS_INCLUDE_JIT_BLOCKCHAIN_H_
+
+#include "etiss/jit/CPU.h"
+#include "etiss/jit/System.h"
+#include "etiss/jit/types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef etiss_int32 (*ETISS_BlockFunction)(ETISS_CPU *cpu, ETISS_System *system,
+                                               void *const *plugin_pointers);
+
+#pragma pack(push, 1) // NEVER ALLOW ALIGNMENT OF STRUCTURE MEMBERS
+    /**
+            @brief linked successor of a block
+    */
+    struct ETISS_BlockChainSlot
+    {
+        etiss_uint64 start;                  /**< @brief start instruction index of the successor */
+        etiss_uint64 end;                    /**< @brief end instruction index of the successor (excluded) */
+        ETISS_BlockFunction const *function; /**< @brief current function of the successor; 0 if not linked */
+        const etiss_uint8 *valid;            /**< @brief validity flag of the successor */
+    };
+
+    /**
+            @brief chaining state of a block; the global variable <block function name>_chain of the compiled code
+    */
+    struct ETISS_BlockChain
+    {
+        struct ETISS_BlockChainSlot next;
+        struct ETISS_BlockChainSlot branch;
+        etiss_int32 *budget; /**< @brief remaining blocks that may be chained; shared by all blocks */
+        void **last;         /**< @brief receives self of the block that returns to the simulation loop */
+        void *self;          /**< @brief etiss::BlockLink of this block */
+        /** @brief no successor is called once cpuTime_ps reached this time. may change while a chain runs (e.g. the
+            next wake-up of etiss::EventQueue); 0 if there is no deadline */
+        const volatile etiss_uint64 *deadline;
+    };
+#pragma pack(pop)
+
+    typedef struct ETISS_BlockChainSlot ETISS_BlockChainSlot;
+    typedef struct ETISS_BlockChain ETISS_BlockChain;
+
+    /**
+            @brief called by the wrapper of a block function with the return code of the block. continues with a
+       linked successor or returns to the simulation loop
+    */
+    static inline etiss_int32 ETISS_BlockChain_continue(ETISS_BlockChain *chain, etiss_int32 ret, ETISS_CPU *cpu,
+                                                        ETISS_System *system, void *const *plugin_pointers)
+    {
+        if (ret == 0 && chain->budget != 0 && --(*chain->budget) > 0 &&
+            (chain->deadline == 0 || cpu->cpuTime_ps < *chain->deadline))
+        {
+            const etiss_uint64 ip = cpu->instructionPointer;
+            if (chain->next.function != 0 && ip >= chain->next.start && ip < chain->next.end && *chain->next.valid)
+                return (*chain->next.function)(cpu, system, plugin_pointers);
+            if (chain->branch.function != 0 && ip >= chain->branch.start && ip < chain->branch.end &&
+                *chain->branch.valid)
+                return (*chain->branch.function)(cpu, system, plugin_pointers);
+        }
+        if (chain->last != 0)
+            *chain->last = chain->self;
+        return ret;
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
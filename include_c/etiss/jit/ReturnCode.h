@@ -183,6 +183,8 @@ defineReturnCode(GDBNOERROR, -16,
 defineReturnCode(SYSCALL, -17, "System call");
 defineReturnCode(PAGEFAULT, -18, "Virtual memory tranlation fault.");
 defineReturnCode(BREAKPOINT, -19, "Break point.");
+defineReturnCode(RELOADALLBLOCKS, -20,
+                 "Clear all cached translated blocks (RELOADBLOCKS only clears written code if writes are tracked).");
 defineReturnCode(CPUFINISHED, 1 << 31,
                  "Finished cpu execution. This is the proper way to exit from "
                  "etiss::CPUCore::execute.");
@@ -65,6 +65,22 @@ extern "C"
 #endif
 
 #pragma pack(push, 1) // NEVER ALLOW ALIGNMENT OF STRUCTURE MEMBERS
+    /**
+            @brief host memory of plain ram that translated code may access directly instead of calling
+       ETISS_System::dread/dwrite (direct memory interface). accesses through a range have no side effects and don't
+       advance the simulation time
+    */
+    struct ETISS_DMIRange
+    {
+        etiss_uint8 *mem;   /**< @brief host address of start */
+        etiss_uint64 start; /**< @brief first address of the range */
+        etiss_uint64 end;   /**< @brief end address of the range (excluded) */
+        etiss_uint32 flags; /**< @brief ETISS_DMI_READ and/or ETISS_DMI_WRITE */
+    };
+
+#define ETISS_DMI_READ 1
+#define ETISS_DMI_WRITE 2
+
     /**
             @brief memory access and time synchronization functions. the "handle" parameter passed on a function call is
        always the "handle" variable of the structure.
@@ -114,11 +130,68 @@ extern "C"
         void (*syncTime)(void *handle, ETISS_CPU *cpu);
 
         void *handle; /**< @brief custom handle that will be passed to the functions of this structure */
+
+        /**
+                @brief direct memory ranges of this system; 0 if dread/dwrite must be called for every access. a
+           system that wraps another system must not forward the ranges of the wrapped system unless it doesn't need
+           to observe accesses to them. only used with jit.direct_memory (see ETISS_System_dread)
+        */
+        const struct ETISS_DMIRange *dmi;
+        etiss_uint32 dmi_count; /**< @brief number of ranges in dmi */
     };
 #pragma pack(pop)
 
+    typedef struct ETISS_DMIRange ETISS_DMIRange;
     typedef struct ETISS_System ETISS_System;
 
+    /**
+            @brief reads data directly from a matching range of system->dmi or calls system->dread otherwise. used by
+       translated code in place of system->dread
+    */
+    static inline etiss_int32 ETISS_System_dread(ETISS_System *system, ETISS_CPU *cpu, etiss_uint64 addr,
+                                                 etiss_uint8 *buffer, etiss_uint32 length)
+    {
+        etiss_uint32 i;
+        etiss_uint32 j;
+        for (i = 0; i < system->dmi_count; i++)
+        {
+            const ETISS_DMIRange *range = system->dmi + i;
+            if ((range->flags & ETISS_DMI_READ) && addr >= range->start && addr < range->end &&
+                length <= range->end - addr)
+            {
+                const etiss_uint8 *mem = range->mem + (addr - range->start);
+                for (j = 0; j < length; j++)
+                    buffer[j] = mem[j];
+                return 0;
+            }
+        }
+        return (*(system->dread))(system->handle, cpu, addr, buffer, length);
+    }
+
+    /**
+            @brief writes data directly to a matching range of system->dmi or calls system->dwrite otherwise. used by
+       translated code in place of system->dwrite
+    */
+    static inline etiss_int32 ETISS_System_dwrite(ETISS_System *system, ETISS_CPU *cpu, etiss_uint64 addr,
+                                                  etiss_uint8 *buffer, etiss_uint32 length)
+    {
+        etiss_uint32 i;
+        etiss_uint32 j;
+        for (i = 0; i < system->dmi_count; i++)
+        {
+            const ETISS_DMIRange *range = system->dmi + i;
+            if ((range->flags & ETISS_DMI_WRITE) && addr >= range->start && addr < range->end &&
+                length <= range->end - addr)
+            {
+                etiss_uint8 *mem = range->mem + (addr - range->start);
+                for (j = 0; j < length; j++)
+                    mem[j] = buffer[j];
+                return 0;
+            }
+        }
+        return (*(system->dwrite))(system->handle, cpu, addr, buffer, length);
+    }
+
     extern int ETISS_System_isvalid(ETISS_System *sys);
 
 #ifdef __cplusplus
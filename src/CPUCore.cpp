@@ -289,6 +289,47 @@ std::list<std::string> CPUCore::list()
     return ret;
 }
 
+bool CPUCore::checkpoint()
+{
+    const size_t size = arch_->getCPUStructSize();
+    if (size == 0 || mmu_enabled_)
+    {
+        etiss::log(etiss::ERROR, "CPUCore::checkpoint: not supported by the architecture or with a MMU", *this);
+        return false;
+    }
+    checkpoint_cpu_.assign((etiss::uint8 *)cpu_, (etiss::uint8 *)cpu_ + size);
+    checkpoint_plugins_.clear();
+    for (auto &plugin : plugins)
+        plugin->saveState(checkpoint_plugins_[plugin.get()]);
+    if (vcpu_)
+        vcpu_->checkpointTriggers(); // fault injection
+    return true;
+}
+
+bool CPUCore::restore()
+{
+    if (checkpoint_cpu_.empty())
+    {
+        etiss::log(etiss::ERROR, "CPUCore::restore: no checkpoint", *this);
+        return false;
+    }
+    // the structure only contains pointers into itself; they are still valid
+    memcpy(cpu_, checkpoint_cpu_.data(), checkpoint_cpu_.size());
+    for (auto &plugin : plugins)
+    {
+        auto state = checkpoint_plugins_.find(plugin.get());
+        if (state != checkpoint_plugins_.end())
+            plugin->restoreState(state->second);
+        // event driven plugins compute their next wake-up for the restored time
+        auto c = plugin->getCoroutinePlugin();
+        if (c)
+            c->scheduleAt(0);
+    }
+    if (vcpu_)
+        vcpu_->restoreTriggers();
+    return true;
+}
+
 CPUCore::~CPUCore()
 {
     arch_->deleteInterruptVector(intvector_, cpu_);
@@ -459,6 +500,11 @@ static void etiss_CPUCore_handleException(ETISS_CPU *cpu, etiss::int32 &code, Bl
     {
     case RETURNCODE::RELOADBLOCKS:
         block_ptr = 0; // doesn't hold a reference and thus might become invalid
+        translator.invalidateWrittenCode(); // unloads all blocks unless writes to code are tracked
+        code = RETURNCODE::NOERROR;
+        return;
+    case RETURNCODE::RELOADALLBLOCKS:
+        block_ptr = 0;
         translator.unloadBlocks();
         code = RETURNCODE::NOERROR;
         return;
@@ -471,6 +517,17 @@ static void etiss_CPUCore_handleException(ETISS_CPU *cpu, etiss::int32 &code, Bl
     case RETURNCODE::GDBNOERROR:
         code = RETURNCODE::NOERROR;
         return;
+    case RETURNCODE::ILLEGALJUMP:
+        if (block_ptr && block_ptr->pretranslated)
+        {
+            // the linear sweep of the pre-translation didn't hit this instruction boundary; translate on demand
+            block_ptr->valid = false;
+            block_ptr = 0;
+            code = RETURNCODE::NOERROR;
+            return;
+        }
+        code = arch->handleException(code, cpu);
+        return;
     case RETURNCODE::CPUFINISHED:
         return;
     default:
@@ -589,6 +646,15 @@ etiss::int32 CPUCore::execute(ETISS_System &_system)
         plugins.push_back(std::make_shared<etiss::mm::DMMUWrapper>(mmu_));
     }
 
+    // track writes to translated code. added after the DMMUWrapper to see the same (virtual) addresses as the
+    // translation
+    std::shared_ptr<etiss::CodePageTracker> codetracker;
+    if (etiss::cfg().get<bool>("jit.track_code_writes", false))
+    {
+        codetracker = std::make_shared<etiss::CodePageTracker>();
+        plugins.push_back(codetracker);
+    }
+
     // copy system wrapper plugins to list and update system (pre plugin init)
     std::list<SystemWrapperPlugin *> syswrappers;
     for (auto &plugin : plugins)
@@ -627,13 +693,28 @@ etiss::int32 CPUCore::execute(ETISS_System &_system)
         etiss::log(etiss::INFO, m.str());
     }
 
-    // copy coroutine plugins to array
+    // copy coroutine plugins to array. with etiss.event_queue event driven plugins are only executed at their wake-up
+    // times instead of before every block
+    const bool eventqueue = etiss::cfg().get<bool>("etiss.event_queue", false);
+    events_.clear();
     std::vector<CoroutinePlugin *> cor_array;
+    std::vector<CoroutinePlugin *> cor_events; // event driven coroutine plugins
+    std::vector<CoroutinePlugin *> cor_due;
     for (const auto &plugin : plugins)
     {
         auto c = plugin->getCoroutinePlugin();
-        if (c)
+        if (!c)
+            continue;
+        if (eventqueue && c->isEventDriven())
+        {
+            c->eventqueue_ = &events_;
+            events_.schedule(c, 0); // first call at the start of the execution
+            cor_events.push_back(c);
+        }
+        else
+        {
             cor_array.push_back(c);
+        }
     }
 
     // create translation object
@@ -646,6 +727,15 @@ etiss::int32 CPUCore::execute(ETISS_System &_system)
     {
         etiss::log(etiss::FATALERROR, "Failed to initialize translation");
     }
+    if (mmu_enabled_)
+    {
+        translation.disableChaining(); // every instruction fetch of a new block must be translated by the MMU
+        translation.enablePhysicalTags(mmu_->GetPageOffsetBits());
+    }
+    translation.setCodeTracker(codetracker.get());
+    translation.setChainDeadline(events_.nextLocation()); // chains stop at the next wake-up
+    if (!pretranslation_ranges_.empty() && etiss::cfg().get<bool>("jit.pretranslate", false))
+        translation.pretranslate(pretranslation_ranges_);
 
     // enable RegisterDevicePlugin listeneing by adding a listener to all fields of the VirtualStruct
     etiss::VirtualStruct::Field::Listener *listener = 0;
@@ -718,6 +808,27 @@ etiss::int32 CPUCore::execute(ETISS_System &_system)
                     }
                 }
             }
+            // execute event driven coroutines whose wake-up time passed
+            if (unlikely(cpu_->cpuTime_ps >= events_.next()))
+            {
+                cor_due.clear();
+                events_.pop(cpu_->cpuTime_ps, cor_due);
+                for (auto &cor_plugin : cor_due)
+                {
+                    exception = cor_plugin->execute();
+                    if (unlikely(exception != RETURNCODE::NOERROR)) // check exception
+                    {
+                        etiss_CPUCore_handleException(cpu_, exception, blptr, translation, arch_.get());
+                        if (unlikely(exception != RETURNCODE::NOERROR)) // check if exception handling failed
+                        {
+                            goto loopexit; // return exception; terminate cpu
+                        }
+                    }
+                }
+            }
+            // install blocks compiled in the background
+            translation.processCompiledBlocks();
+
             //            std::cout << "blockCounter: " <<  blockCounter++ <<std::endl;
             //            std::cout << "instrcounter: " <<  instrcounter <<std::endl;
             for (unsigned bc = 0; bc < bcc_; bc++)
@@ -731,9 +842,8 @@ etiss::int32 CPUCore::execute(ETISS_System &_system)
                 {
                     if (mmu_->cache_flush_pending)
                     {
-                        // FIXME: When flush required, current instruction cache has to be cleared. However, the
-                        // unloadBlocks is much too time-comsuming than expected. It should be optimized later on.
-                        // translation.unloadBlocks(0,(uint64_t)((int64_t)-1));
+                        // translated blocks are physically tagged and thus stay valid for other address spaces.
+                        // blocks of changed mappings are no longer found since their physical address differs
                         mmu_->cache_flush_pending = false;
                         blptr = nullptr;
                     }
@@ -747,10 +857,9 @@ etiss::int32 CPUCore::execute(ETISS_System &_system)
                         // Update pma, in case pc is redirected to physical address space
                         pma = cpu_->instructionPointer;
                     }
+                    translation.setFetchAddress(pma);
                 }
 
-                // FIXME: cpu->instructionPointer contains virtual address, getBlockFast should use physical address
-                // instead to realize physical cache.
                 blptr = translation.getBlockFast(
                     blptr, cpu_->instructionPointer); // IMPORTANT: no pointer reference is kept here. if the translator
                                                       // performs a cleanup then blptr must be set to 0
@@ -780,10 +889,14 @@ etiss::int32 CPUCore::execute(ETISS_System &_system)
 #if ETISS_CPUCORE_DBG_APPROXIMATE_INSTRUCTION_COUNTER
                     uint64 oldinstrptr = cpu_->instructionPointer; // TESTING
 #endif
+                    translation.countExecution(blptr);
+
                     // plugins_handle_ has the pointer to all translation plugins,
                     // In the generated code these plugin handles are named "plugin_pointers" and can be used to access
                     // a variable of the plugin
+                    translation.startChain(blptr);
                     exception = (*(blptr->execBlock))(cpu_, system, plugins_handle_);
+                    blptr = translation.endChain(); // differs from blptr if the block continued with linked blocks
 
 #if ETISS_CPUCORE_DBG_APPROXIMATE_INSTRUCTION_COUNTER
                     instrcounter +=
@@ -802,6 +915,13 @@ etiss::int32 CPUCore::execute(ETISS_System &_system)
                         goto loopexit; // exception; terminate cpu
                     }
                 }
+
+                // unload blocks of written code (self modifying code). the current block may be affected
+                if (unlikely(codetracker && codetracker->hasWrittenCode()))
+                {
+                    blptr = 0;
+                    translation.invalidateWrittenCode();
+                }
             }
 
             // sync time after block
@@ -819,6 +939,12 @@ loopexit:
     {
         cor_plugin->executionEnd(exception);
     }
+    for (auto &cor_plugin : cor_events)
+    {
+        cor_plugin->executionEnd(exception);
+        cor_plugin->eventqueue_ = nullptr;
+    }
+    events_.clear();
 
     // Defining the statistics of measurement and printing them
     double cpu_time = cpu_->cpuTime_ps / 1.0E12;
@@ -901,6 +1027,10 @@ loopexit:
             break;
         }
     }
+    if (codetracker)
+    {
+        plugins.remove(codetracker);
+    }
 
     if (listener)
     {
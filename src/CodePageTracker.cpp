@@ -0,0 +1,196 @@
+/*
+
+        @copyright
+
+        <pre>
+
+        Copyright 2018 Infineon Technologies AG
+
+        This file is part of ETISS tool, see <https://github.com/tum-ei-eda/etiss>.
+
+        The initial version of this software has been created with the funding support by the German Federal
+        Ministry of Education and Research (BMBF) in the project EffektiV under grant 01IS13022.
+
+        Redistribution and use in source and binary forms, with or without modification, are permitted
+        provided that the following conditions are met:
+
+        1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+        the following disclaimer.
+
+        2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+        and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+        3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+        or promote products derived from this software without specific prior written permission.
+
+        THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+        WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+        PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+        DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+        PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+        HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+        NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+        POSSIBILITY OF SUCH DAMAGE.
+
+        </pre>
+
+        @author Chair of Electronic Design Automation, TUM
+
+        @version 0.1
+
+*/
+/**
+        @file
+
+        @brief implementation of etiss::CodePageTracker
+
+*/
+
+#include "etiss/CodePageTracker.h"
+
+namespace etiss
+{
+
+namespace
+{
+
+struct CodePageTrackerSystem
+{
+    struct ETISS_System sys;
+    CodePageTracker *this_;
+    ETISS_System *orig;
+};
+
+etiss_int32 iread(void *handle, ETISS_CPU *cpu, etiss_uint64 addr, etiss_uint32 length)
+{
+    ETISS_System *sys = ((CodePageTrackerSystem *)handle)->orig;
+    return sys->iread(sys->handle, cpu, addr, length);
+}
+
+etiss_int32 iwrite(void *handle, ETISS_CPU *cpu, etiss_uint64 addr, etiss_uint8 *buffer, etiss_uint32 length)
+{
+    CodePageTrackerSystem *tsys = (CodePageTrackerSystem *)handle;
+    tsys->this_->written(addr, length);
+    ETISS_System *sys = tsys->orig;
+    return sys->iwrite(sys->handle, cpu, addr, buffer, length);
+}
+
+etiss_int32 dread(void *handle, ETISS_CPU *cpu, etiss_uint64 addr, etiss_uint8 *buffer, etiss_uint32 length)
+{
+    ETISS_System *sys = ((CodePageTrackerSystem *)handle)->orig;
+    return sys->dread(sys->handle, cpu, addr, buffer, length);
+}
+
+etiss_int32 dwrite(void *handle, ETISS_CPU *cpu, etiss_uint64 addr, etiss_uint8 *buffer, etiss_uint32 length)
+{
+    CodePageTrackerSystem *tsys = (CodePageTrackerSystem *)handle;
+    tsys->this_->written(addr, length);
+    ETISS_System *sys = tsys->orig;
+    return sys->dwrite(sys->handle, cpu, addr, buffer, length);
+}
+
+etiss_int32 dbg_read(void *handle, etiss_uint64 addr, etiss_uint8 *buffer, etiss_uint32 length)
+{
+    ETISS_System *sys = ((CodePageTrackerSystem *)handle)->orig;
+    return sys->dbg_read(sys->handle, addr, buffer, length);
+}
+
+etiss_int32 dbg_write(void *handle, etiss_uint64 addr, etiss_uint8 *buffer, etiss_uint32 length)
+{
+    CodePageTrackerSystem *tsys = (CodePageTrackerSystem *)handle;
+    tsys->this_->written(addr, length);
+    ETISS_System *sys = tsys->orig;
+    return sys->dbg_write(sys->handle, addr, buffer, length);
+}
+
+void syncTime(void *handle, ETISS_CPU *cpu)
+{
+    ETISS_System *sys = ((CodePageTrackerSystem *)handle)->orig;
+    sys->syncTime(sys->handle, cpu);
+}
+
+} // namespace
+
+CodePageTracker::CodePageTracker() : chunks_((size_t)1 << (32 - REGION_BITS - CHUNK_BITS)), chainbudget_(nullptr) {}
+
+CodePageTracker::~CodePageTracker() {}
+
+ETISS_System *CodePageTracker::wrap(ETISS_CPU *cpu, ETISS_System *system)
+{
+    CodePageTrackerSystem *ret = new CodePageTrackerSystem();
+
+    ret->sys.iread = &iread;
+    ret->sys.iwrite = &iwrite;
+    ret->sys.dread = &dread;
+    ret->sys.dwrite = &dwrite;
+    ret->sys.dbg_read = &dbg_read;
+    ret->sys.dbg_write = &dbg_write;
+    ret->sys.syncTime = &syncTime;
+
+    ret->sys.handle = (void *)ret;
+    ret->this_ = this;
+    ret->orig = system;
+
+    return (ETISS_System *)ret;
+}
+
+ETISS_System *CodePageTracker::unwrap(ETISS_CPU *cpu, ETISS_System *system)
+{
+    ETISS_System *ret = ((CodePageTrackerSystem *)system)->orig;
+    delete (CodePageTrackerSystem *)system;
+    return ret;
+}
+
+void CodePageTracker::addCode(etiss::uint64 start, etiss::uint64 end)
+{
+    if (end <= start)
+        return;
+    const etiss::uint64 last = (end - 1) >> REGION_BITS;
+    for (etiss::uint64 region = start >> REGION_BITS; region <= last; region++)
+    {
+        if ((region >> (32 - REGION_BITS)) != 0)
+        {
+            highcode_.insert(region);
+            continue;
+        }
+        std::unique_ptr<etiss::uint64[]> &chunk = chunks_[region >> CHUNK_BITS];
+        if (!chunk)
+        {
+            chunk.reset(new etiss::uint64[(1 << CHUNK_BITS) / 64]());
+        }
+        const etiss::uint64 bit = region & ((1 << CHUNK_BITS) - 1);
+        chunk[bit >> 6] |= ((etiss::uint64)1) << (bit & 63);
+    }
+}
+
+void CodePageTracker::markWritten(etiss::uint64 region)
+{
+    // unmark to record each region once; translation marks it again
+    if ((region >> (32 - REGION_BITS)) != 0)
+    {
+        highcode_.erase(region);
+    }
+    else
+    {
+        const etiss::uint64 bit = region & ((1 << CHUNK_BITS) - 1);
+        chunks_[region >> CHUNK_BITS][bit >> 6] &= ~(((etiss::uint64)1) << (bit & 63));
+    }
+    written_.push_back(region << REGION_BITS);
+    // the valid flags of chained successors are only cleared by invalidateWrittenCode in the simulation loop
+    if (chainbudget_ != nullptr)
+        *chainbudget_ = 0;
+}
+
+std::vector<etiss::uint64> CodePageTracker::takeWrittenRegions()
+{
+    std::vector<etiss::uint64> ret;
+    ret.swap(written_);
+    return ret;
+}
+
+std::string CodePageTracker::_getPluginName() const
+{
+    return "CodePageTracker";
+}
+
+} // namespace etiss
@@ -52,6 +52,8 @@
 
 #include "etiss/CodePart.h"
 
+#include <regex>
+
 using namespace etiss;
 
 void CodeSet::writeCodeParts(std::string &code, const std::list<CodePart> &parts, bool required, RegisterSet &ignored,
@@ -143,6 +145,22 @@ std::string CodeSet::toString(RegisterSet &ignored, bool &ok) const
     return code;
 }
 
+/**
+    returns the code of a line. shared by the switch and the straight-line layout of CodeBlock::toCode
+*/
+static std::string lineCode(CodeBlock::Line &line, RegisterSet &ignored)
+{
+    bool ok = true;
+    std::string code = line.getCodeSet().toString(ignored, ok);
+    if (!ok)
+    {
+        std::stringstream ss;
+        ss << "failed to generate the code of the instruction at 0x" << std::hex << line.getAddress();
+        etiss::log(etiss::ERROR, ss.str());
+    }
+    return code;
+}
+
 void CodeBlock::toCode(std::stringstream &out, const std::string &funcname, std::set<std::string> *fileglobalcode)
 {
 
@@ -177,6 +195,21 @@ void CodeBlock::toCode(std::stringstream &out, const std::string &funcname, std:
         out << *iter;
     }
 
+    if (singleentry_)
+    {
+        // straight-line code; the guard only fails if a caller ignored the entry range of the block
+        out << "\n\tif (blockglobal_jumpaddr != 0) return ETISS_RETURNCODE_ILLEGALJUMP;\n";
+        std::list<std::string> parts;
+        RegisterSet ignored; // collected in reverse order like the cases below
+        for (auto iter = lines_.rbegin(); iter != lines_.rend(); iter++)
+            parts.push_front("\t{\n" + lineCode(*iter, ignored) + "\t}\n");
+        for (auto iter = parts.begin(); iter != parts.end(); iter++)
+            out << *iter;
+        out << exit_code << "\treturn ETISS_RETURNCODE_NOERROR;\n"
+                            "}\n\n";
+        return;
+    }
+
     out << "\n\tswitch(blockglobal_jumpaddr){\n";
     std::list<std::string> cases;
     {
@@ -193,11 +226,10 @@ void CodeBlock::toCode(std::stringstream &out, const std::string &funcname, std:
                 etiss::log(etiss::FATALERROR, "error in code block: the line addresses are not in ascending order");
             }
 #endif
-            bool ok = true; // TODO use result
             std::stringstream lss;
             lss << "	case " << (iter->getAddress() - startindex_) << ":\n";
             lss << "		{\n";
-            lss << iter->getCodeSet().toString(ignored, ok);
+            lss << lineCode(*iter, ignored);
             lss << "		}\n";
             cases.push_front(lss.str());
         }
@@ -208,6 +240,191 @@ void CodeBlock::toCode(std::stringstream &out, const std::string &funcname, std:
            "\tdefault:\n"
            "\t\treturn ETISS_RETURNCODE_ILLEGALJUMP;\n"
            "\t}"
-           "\treturn ETISS_RETURNCODE_NOERROR;\n"
+        << exit_code
+        << "\treturn ETISS_RETURNCODE_NOERROR;\n"
            "}\n\n";
 }
+
+/// @return true if code may read or write cpu state outside of its own text (e.g. memory accesses, helper calls)
+static bool observesCPUState(const std::string &code)
+{
+    static const std::regex cpuargument("[(,]\\s*cpu\\s*[,)]");
+    return code.find("system->") != std::string::npos || code.find("plugin_pointers") != std::string::npos ||
+           std::regex_search(code, cpuargument);
+}
+
+/// matches return statements for wrapping into a block that first writes back deferred state
+static const std::regex returnstatement("\\breturn\\b([^;]*);");
+
+/// @return true if the expression code[begin,end) is assigned, compound assigned, incremented or decremented
+static bool isAssigned(const std::string &code, size_t begin, size_t end)
+{
+    size_t next = code.find_first_not_of(" \t", end);
+    if (next != std::string::npos)
+    {
+        const std::string op = code.substr(next, 3);
+        if (op[0] == '=')
+            return op.size() < 2 || op[1] != '=';
+        if (op.size() >= 2 && ((op[0] == '+' && op[1] == '+') || (op[0] == '-' && op[1] == '-')))
+            return true;
+        if (op.size() >= 2 && op[1] == '=' && std::string("+-*/%&|^").find(op[0]) != std::string::npos)
+            return true;
+        if (op == "<<=" || op == ">>=")
+            return true;
+    }
+    size_t prev = begin > 0 ? code.find_last_not_of(" \t(", begin - 1) : std::string::npos;
+    return prev != std::string::npos && prev > 0 &&
+           ((code[prev] == '+' && code[prev - 1] == '+') || (code[prev] == '-' && code[prev - 1] == '-'));
+}
+
+void CodeBlock::cacheRegisters(const std::string &access, const std::string &type, unsigned count)
+{
+    std::vector<CodePart *> parts;
+    for (auto &line : lines_)
+        line.getCodeSet().getParts(parts);
+
+    // find the code that doesn't observe the cpu state and the registers it uses and modifies
+    const std::string pointer = access.substr(1); // access without dereference
+    std::vector<bool> cached(parts.size(), false);
+    std::set<unsigned> used;
+    std::set<unsigned> modified;
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        const std::string &code = parts[i]->code();
+        if (observesCPUState(code))
+            continue;
+        std::set<unsigned> partused;
+        std::set<unsigned> partmodified;
+        size_t accesses = 0;
+        bool ok = true;
+        for (size_t pos = code.find(access); pos != std::string::npos; pos = code.find(access, pos + 1))
+        {
+            size_t end = pos + access.size();
+            unsigned reg = 0;
+            while (end < code.size() && code[end] >= '0' && code[end] <= '9')
+                reg = reg * 10 + (unsigned)(code[end++] - '0');
+            if (end == pos + access.size() || end >= code.size() || code[end] != ']' || reg >= count)
+            {
+                ok = false; // computed index
+                break;
+            }
+            if (isAssigned(code, pos, end + 1))
+                partmodified.insert(reg);
+            partused.insert(reg);
+            accesses++;
+        }
+        size_t pointers = 0;
+        for (size_t pos = code.find(pointer); pos != std::string::npos; pos = code.find(pointer, pos + 1))
+            pointers++;
+        if (!ok || pointers != accesses) // the register pointer itself is used
+            continue;
+        cached[i] = true;
+        used.insert(partused.begin(), partused.end());
+        modified.insert(partmodified.begin(), partmodified.end());
+    }
+    if (used.empty())
+        return;
+
+    auto local = [](unsigned reg) { return "cached_reg_" + std::to_string(reg); };
+    auto memory = [&access](unsigned reg) { return access + std::to_string(reg) + "]"; };
+    std::string writeback;
+    for (unsigned reg : modified)
+        writeback += memory(reg) + " = " + local(reg) + "; ";
+    std::string reload;
+    for (unsigned reg : used)
+    {
+        functionglobal_code.insert(type + " " + local(reg) + " = " + memory(reg) + ";\n");
+        reload += local(reg) + " = " + memory(reg) + "; ";
+    }
+
+    const std::string returnreplacement = "{ " + writeback + "return$1; }";
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        std::string &code = parts[i]->code();
+        if (cached[i])
+        {
+            for (unsigned reg : used)
+            {
+                const std::string mem = memory(reg);
+                const std::string loc = local(reg);
+                for (size_t pos = code.find(mem); pos != std::string::npos; pos = code.find(mem, pos + loc.size()))
+                    code.replace(pos, mem.size(), loc);
+            }
+            if (!writeback.empty())
+                code = std::regex_replace(code, returnstatement, returnreplacement);
+        }
+        else
+        {
+            // the registers in memory are valid while this code runs
+            code = writeback + "\n" + code + "\n" + reload + "\n";
+        }
+    }
+    if (!writeback.empty())
+        exit_code += "\n\t" + writeback + "\n";
+}
+
+/**
+    replaces the time updates of the timing plugins (e.g. etiss::DataSheetAccurateTiming) by additions to
+    deferred_cycles. an update without a cycle count adds one cycle
+*/
+static std::string deferTimeUpdates(const std::string &code, const std::regex &timeupdate)
+{
+    std::string ret;
+    std::sregex_iterator end;
+    std::string::const_iterator last = code.begin();
+    for (std::sregex_iterator m(code.begin(), code.end(), timeupdate); m != end; ++m)
+    {
+        ret.append(last, (*m)[0].first);
+        ret += "deferred_cycles += " + ((*m)[1].matched ? (*m)[1].str() : std::string("1")) + ";";
+        last = (*m)[0].second;
+    }
+    ret.append(last, code.end());
+    return ret;
+}
+
+void CodeBlock::deferStateUpdates()
+{
+    static const std::regex pcstore("cpu->instructionPointer = (\\d+(?:ULL|U)?);");
+    static const std::regex timeupdate("cpu->cpuTime_ps \\+= \\(?(?:(\\d+) \\* )?cpu->cpuCycleTime_ps\\)?;");
+    const std::string flush = "cpu->instructionPointer = deferred_pc; cpu->cpuTime_ps += deferred_cycles * "
+                              "cpu->cpuCycleTime_ps; deferred_cycles = 0; ";
+    const std::string reload = "deferred_pc = cpu->instructionPointer; ";
+
+    std::vector<CodePart *> parts;
+    for (auto &line : lines_)
+        line.getCodeSet().getParts(parts);
+    for (CodePart *part : parts)
+    {
+        std::string &code = part->code();
+        const std::string rest = std::regex_replace(std::regex_replace(code, pcstore, ""), timeupdate, "");
+        if (observesCPUState(code) || rest.find("instructionPointer") != std::string::npos ||
+            rest.find("cpuTime_ps") != std::string::npos)
+        {
+            // the fields in the cpu structure are valid while this code runs
+            code = flush + "\n" + code + "\n" + reload + "\n";
+        }
+        else
+        {
+            code = std::regex_replace(code, pcstore, "deferred_pc = $1;");
+            code = deferTimeUpdates(code, timeupdate);
+            code = std::regex_replace(code, returnstatement, "{ " + flush + "return$1; }");
+        }
+    }
+    functionglobal_code.insert("etiss_uint64 deferred_pc = cpu->instructionPointer;\n");
+    functionglobal_code.insert("etiss_uint64 deferred_cycles = 0;\n");
+    exit_code += "\n\t" + flush + "\n";
+}
+
+void CodeBlock::useDirectMemory()
+{
+    static const std::regex dataaccess("\\(\\*\\(system->(dread|dwrite)\\)\\)\\(\\s*system->handle\\s*,");
+    std::vector<CodePart *> parts;
+    for (auto &line : lines_)
+        line.getCodeSet().getParts(parts);
+    for (CodePart *part : parts)
+    {
+        std::string &code = part->code();
+        if (code.find("system->d") != std::string::npos)
+            code = std::regex_replace(code, dataaccess, "ETISS_System_$1(system,");
+    }
+}
@@ -736,7 +736,26 @@ void etiss_initialize(const std::vector<std::string>& args, bool forced = false)
             ("etiss.max_block_size", po::value<int>(), "Sets maximum amount of instructions in a block.")
             ("etiss.output_path_prefix", po::value<std::string>(), "Path prefix to use when writing output files.")
             ("etiss.loglevel", po::value<int>(), "Verbosity of logging output.")
+            ("etiss.event_queue", po::value<bool>(), "Calls event driven coroutine plugins (e.g. timers) only when the cpu time reached their next deadline instead of before every block. Chained blocks stop at the next deadline.")
             ("jit.gcc.cleanup", po::value<bool>(), "Cleans up temporary files in GCCJIT. ")
+            ("jit.gcc.cache_path", po::value<std::string>(), "Folder of a persistent cache of compiled blocks shared by GCCJIT instances across runs. Disabled if empty.")
+            ("jit.batch_size", po::value<int>(), "Maximum number of consecutive blocks that are translated speculatively and compiled into one library.")
+            ("jit.chaining.budget", po::value<int>(), "Maximum number of linked blocks that execute without returning to the simulation loop. Values > 1 enable direct chaining in the generated code if the JIT compiles tail calls as jumps (not with TCCJIT or jit.debug). Chained blocks are not counted for jit.tiering.threshold and jit.trace.threshold.")
+            ("jit.trace.threshold", po::value<int>(), "Number of executions after which a block is recompiled together with its frequently executed successor blocks as one superblock. Only executions started by the simulation loop are counted. 0 disables trace formation.")
+            ("jit.trace.max_blocks", po::value<int>(), "Maximum number of blocks in a superblock formed by jit.trace.threshold.")
+            ("jit.cache.max_blocks", po::value<int>(), "Maximum number of translated blocks. Least recently executed blocks are evicted if exceeded. 0 means unlimited.")
+            ("jit.cache.max_bytes", po::value<std::string>(), "Maximum size of the generated code of translated blocks in bytes. Least recently executed blocks are evicted if exceeded. 0 means unlimited.")
+            ("jit.async.threads", po::value<int>(), "Number of threads compiling blocks with jit.type in the background. New blocks run with jit.fast_type until their compilation finished. 0 disables asynchronous compilation.")
+            ("jit.tiering.threshold", po::value<int>(), "Number of executions after which a block compiled with jit.fast_type is recompiled with jit.type. Only executions started by the simulation loop are counted. 0 disables tiered compilation.")
+            ("jit.fast_type", po::value<std::string>(), "Fast JIT compiler (e.g. TCCJIT) used for new blocks with asynchronous or tiered compilation.")
+            ("jit.pretranslate", po::value<bool>(), "Translates the executable segments of the loaded ELF file before the simulation starts. Combine with jit.gcc.cache_path to reuse the compiled code in later runs.")
+            ("jit.aot.threads", po::value<int>(), "Number of threads compiling the libraries of jit.pretranslate. Defaults to the number of hardware threads.")
+            ("jit.aot.batch_size", po::value<int>(), "Number of blocks compiled into one library by jit.pretranslate.")
+            ("jit.defer_state_updates", po::value<bool>(), "Defers the program counter and cpu time updates of translated instructions to the exits of a block and to code that may observe them.")
+            ("jit.single_entry", po::value<bool>(), "Translates blocks as straight-line code that can only be entered at the first instruction. Jumps into a block translate a new block at the target.")
+            ("jit.direct_memory", po::value<bool>(), "Translated code accesses the memory ranges published by the system (etiss::System::getDMIRanges) directly instead of calling dread/dwrite. Requires zero initialized dmi fields of custom ETISS_System structures.")
+            ("jit.cache_registers", po::value<bool>(), "Keeps the general purpose registers in local variables of a translated block if supported by the architecture.")
+            ("jit.track_code_writes", po::value<bool>(), "Track writes to translated code to unload only the blocks of written memory on self modifying code and instruction cache flushes.")
             ("jit.verify", po::value<bool>(), "Run some basic checks to verify the functionality of the JIT engine.")
             ("jit.debug", po::value<bool>(), "Causes the JIT Engines to compile in debug mode.")
             ("jit.type", po::value<std::string>(), "The JIT compiler to use.")
@@ -744,17 +763,28 @@ void etiss_initialize(const std::vector<std::string>& args, bool forced = false)
             ("jit.external_libs", po::value<std::string>(), "List of semicolon-separated library names for the JIT to link.")
             ("jit.external_header_paths", po::value<std::string>(), "List of semicolon-separated headers paths for the JIT.")
             ("jit.external_lib_paths", po::value<std::string>(), "List of semicolon-separated library paths for the JIT.")
+            ("faults.compile_triggers", po::value<bool>(), "The generated code of the InstructionAccurateCallback plugin checks a table of the VARIABLEVALUE and TIME fault triggers and only calls the fault injector if one holds. Changed triggers update the table without a new translation.")
             ("vp.sw_binary_ram", po::value<std::string>(), "Path to binary file to be loaded into RAM.")
             ("vp.sw_binary_rom", po::value<std::string>(), "Path to binary file to be loaded into ROM.")
             ("vp.elf_file", po::value<std::string>(), "Load ELF file.")
             ("vp.stats_file_path", po::value<std::string>(), "Path where the output json file gets stored after bare processor is run.")
+            ("vp.replay.start_ps", po::value<std::string>(), "Cpu time at which the bare processor saves a checkpoint of the cpu, the plugins and the memory (see vp.replay.end_ps).")
+            ("vp.replay.end_ps", po::value<std::string>(), "Cpu time at which the bare processor restores the checkpoint of vp.replay.start_ps. The section in between is repeated vp.replay.runs times with the translated code kept loaded.")
+            ("vp.replay.runs", po::value<int>(), "Number of repetitions of the section between vp.replay.start_ps and vp.replay.end_ps.")
             ("simple_mem_system.print_dbus_access", po::value<bool>(), "Traces accesses to the data bus.")
             ("simple_mem_system.print_ibus_access", po::value<bool>(), "Traces accesses to the instruction bus.")
             ("simple_mem_system.print_dbgbus_access", po::value<bool>(), "Traces accesses to the debug bus.")
+            ("simple_mem_system.mmap", po::value<bool>(), "Allocate the memory segments with demand-zero pages (mmap) and map image files and ELF segments copy-on-write where the page alignment allows instead of copying them.")
             ("simple_mem_system.print_to_file", po::value<bool>(), "Write all tracing to a file instead of the terminal. The file will be located at etiss.output_path_prefix.")
             ("plugin.logger.logaddr", po::value<std::string>(), "Provides the compare address that is used to check for memory accesses that are redirected to the logger.")
             ("plugin.logger.logmask", po::value<std::string>(), "Provides the mask that is used to check for memory accesses that are redirected to the logger.")
             ("plugin.gdbserver.port", po::value<std::string>(), "Option for gdbserver")
+            ("plugin.faultcampaign.xml", po::value<std::string>(), "Fault definitions of a campaign run by the FaultCampaign plugin. Each fault is applied by its own forked worker.")
+            ("plugin.faultcampaign.result", po::value<std::string>(), "CSV file the FaultCampaign plugin writes one line per experiment to.")
+            ("plugin.faultcampaign.workers", po::value<int>(), "Maximum number of concurrently running FaultCampaign workers. Defaults to the number of hardware threads.")
+            ("plugin.faultcampaign.sample_ps", po::value<std::string>(), "CPU time between two cpu state samples compared with the golden run to find the divergence point of an experiment.")
+            ("plugin.faultcampaign.max_samples", po::value<std::string>(), "Maximum number of cpu state samples recorded by the golden run of the FaultCampaign plugin.")
+            ("plugin.faultcampaign.timeout_factor", po::value<int>(), "FaultCampaign workers are stopped after running this many times as long as the golden run. 0 disables the timeout.")
             ("pluginToLoad,p", po::value<std::vector<std::string>>()->multitoken(), "List of plugins to be loaded.")
             ;
 
@@ -0,0 +1,97 @@
+/*
+
+        @copyright
+
+        <pre>
+
+        Copyright 2018 Infineon Technologies AG
+
+        This file is part of ETISS tool, see <https://github.com/tum-ei-eda/etiss>.
+
+        The initial version of this software has been created with the funding support by the German Federal
+        Ministry of Education and Research (BMBF) in the project EffektiV under grant 01IS13022.
+
+        Redistribution and use in source and binary forms, with or without modification, are permitted
+        provided that the following conditions are met:
+
+        1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+        the following disclaimer.
+
+        2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+        and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+        3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+        or promote products derived from this software without specific prior written permission.
+
+        THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+        WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+        PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+        DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+        PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+        HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+        NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+        POSSIBILITY OF SUCH DAMAGE.
+
+        </pre>
+
+        @author Chair of Electronic Design Automation, TUM
+
+        @version 0.1
+
+*/
+/**
+        @file
+
+        @brief implementation of etiss::EventQueue
+
+*/
+
+#include "etiss/EventQueue.h"
+
+namespace etiss
+{
+
+const etiss::uint64 EventQueue::NEVER;
+
+EventQueue::EventQueue() : next_(NEVER) {}
+
+void EventQueue::schedule(CoroutinePlugin *plugin, etiss::uint64 time_ps)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    auto iter = pending_.find(plugin);
+    if (iter != pending_.end())
+    {
+        events_.erase(iter->second);
+        pending_.erase(iter);
+    }
+    if (time_ps != NEVER)
+        pending_[plugin] = events_.insert(std::make_pair(time_ps, plugin));
+    updateNext();
+}
+
+void EventQueue::clear()
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    events_.clear();
+    pending_.clear();
+    updateNext();
+}
+
+void EventQueue::pop(etiss::uint64 time_ps, std::vector<CoroutinePlugin *> &due)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    while (!events_.empty() && events_.begin()->first <= time_ps)
+    {
+        due.push_back(events_.begin()->second);
+        pending_.erase(events_.begin()->second);
+        events_.erase(events_.begin());
+    }
+    updateNext();
+}
+
+void EventQueue::updateNext()
+{
+    next_ = events_.empty() ? NEVER : events_.begin()->first;
+}
+
+} // namespace etiss
@@ -62,8 +62,12 @@
 #include "etiss/IntegratedLibrary/Logger.h"
 #include "etiss/IntegratedLibrary/PrintInstruction.h"
 #include "etiss/IntegratedLibrary/errorInjection/Plugin.h"
+#include "etiss/IntegratedLibrary/fault/FaultCampaign.h"
 #include "etiss/IntegratedLibrary/gdb/GDBServer.h"
 
+#include <algorithm>
+#include <thread>
+
 extern "C"
 {
 
@@ -74,7 +78,7 @@ extern "C"
 
     unsigned ETISSINCLUDED_countCPUArch() { return 0; }
 
-    unsigned ETISSINCLUDED_countPlugin() { return 4; }
+    unsigned ETISSINCLUDED_countPlugin() { return 5; }
 
     const char *ETISSINCLUDED_nameJIT(unsigned index) { return 0; }
 
@@ -92,6 +96,8 @@ extern "C"
             return "PrintInstruction";
         case 3:
             return "Logger";
+        case 4:
+            return "FaultCampaign";
         }
         return 0;
     }
@@ -133,11 +139,25 @@ extern "C"
         case 2:
             return new etiss::plugin::PrintInstruction();
         case 3:
+        {
             etiss::Configuration cfg;
             cfg.config() = options;
             return new etiss::plugin::Logger(cfg.get<uint64_t>("plugin.logger.logaddr", 0x80000000),
                                              cfg.get<uint64_t>("plugin.logger.logmask", 0xF0000000));
         }
+        case 4:
+        {
+            etiss::Configuration cfg;
+            cfg.config() = options;
+            return new etiss::plugin::fault::FaultCampaign(
+                cfg.get<std::string>("plugin.faultcampaign.xml", ""),
+                cfg.get<std::string>("plugin.faultcampaign.result", "faultcampaign.csv"),
+                cfg.get<unsigned>("plugin.faultcampaign.workers", std::max(1u, std::thread::hardware_concurrency())),
+                cfg.get<uint64_t>("plugin.faultcampaign.sample_ps", 1000000),
+                cfg.get<uint64_t>("plugin.faultcampaign.max_samples", 1 << 22),
+                cfg.get<unsigned>("plugin.faultcampaign.timeout_factor", 2));
+        }
+        }
         return 0;
     }
 
@@ -44,11 +44,14 @@
 #include "etiss/CPUCore.h"
 #include "etiss/Instruction.h"
 
+#include <sstream>
+
 extern "C"
 {
     void etiss_plugin_InstructionAccurateCallback(void *ptr)
     {
-        etiss::plugin::InstructionAccurateCallback &vvl = *(etiss::plugin::InstructionAccurateCallback *)ptr;
+        etiss::plugin::InstructionAccurateCallback &vvl =
+            *((etiss::plugin::InstructionAccurateCallback::Data *)ptr)->this_;
         vvl.call();
     }
 }
@@ -59,12 +62,60 @@ namespace etiss
 namespace plugin
 {
 
-InstructionAccurateCallback::InstructionAccurateCallback() {}
+static_assert(sizeof(etiss::fault::Injector::TriggerTable) ==
+                  (3 + 3 * etiss::fault::Injector::TriggerTable::MAX_FIELDS) * sizeof(uint64_t),
+              "the trigger table must match the layout declared in translated code");
+
+InstructionAccurateCallback::InstructionAccurateCallback()
+    : compiletriggers_(etiss::cfg().get<bool>("faults.compile_triggers", false)), tablevalid_(false), generation_(0)
+{
+    // call the injector for every instruction until the table is filled
+    pluginData_.table_.always = 1;
+    pluginData_.table_.time_ps = 0;
+    pluginData_.table_.fields = 0;
+    pluginData_.this_ = this;
+}
 InstructionAccurateCallback::~InstructionAccurateCallback() {}
 
 void InstructionAccurateCallback::initCodeBlock(etiss::CodeBlock &block) const
 {
     block.fileglobalCode().insert("extern void etiss_plugin_InstructionAccurateCallback(void *); ");
+    if (!useTriggerTable())
+        return;
+    // layout of etiss::fault::Injector::TriggerTable
+    std::stringstream ss;
+    ss << "typedef struct {\n"
+          "    etiss_uint64 always;\n"
+          "    etiss_uint64 time_ps;\n"
+          "    etiss_uint64 fields;\n"
+          "    struct { etiss_uint64 offset; etiss_uint64 width; etiss_uint64 value; } field["
+       << etiss::fault::Injector::TriggerTable::MAX_FIELDS
+       << "];\n"
+          "} etiss_plugin_InstructionAccurateCallback_triggers;\n"
+          "static inline int etiss_plugin_InstructionAccurateCallback_check(ETISS_CPU * const cpu, const void * const "
+          "ptr)\n"
+          "{\n"
+          "    const etiss_plugin_InstructionAccurateCallback_triggers * const t =\n"
+          "        (const etiss_plugin_InstructionAccurateCallback_triggers *)ptr;\n"
+          "    if (t->always || cpu->cpuTime_ps >= t->time_ps)\n"
+          "        return 1;\n"
+          "    for (etiss_uint64 i = 0; i < t->fields; i++)\n"
+          "    {\n"
+          "        const etiss_uint8 * const f = (const etiss_uint8 *)cpu + t->field[i].offset;\n"
+          "        etiss_uint64 v;\n"
+          "        switch (t->field[i].width)\n"
+          "        {\n"
+          "        case 1: v = *(const etiss_uint8 *)f; break;\n"
+          "        case 2: v = *(const etiss_uint16 *)f; break;\n"
+          "        case 4: v = *(const etiss_uint32 *)f; break;\n"
+          "        default: v = *(const etiss_uint64 *)f; break;\n"
+          "        }\n"
+          "        if (v == t->field[i].value)\n"
+          "            return 1;\n"
+          "    }\n"
+          "    return 0;\n"
+          "}\n";
+    block.fileglobalCode().insert(ss.str());
 }
 
 void InstructionAccurateCallback::finalizeInstrSet(etiss::instr::ModedInstructionSet &mis) const
@@ -74,9 +125,14 @@ void InstructionAccurateCallback::finalizeInstrSet(etiss::instr::ModedInstructio
             is.foreach ([this](etiss::instr::Instruction &i) {
                 i.addCallback(
                     [this](etiss::instr::BitArray &, etiss::CodeSet &cs, etiss::instr::InstructionContext &) {
+                        std::string call =
+                            std::string("etiss_plugin_InstructionAccurateCallback(") + getPointerCode() + ");";
+                        if (useTriggerTable())
+                            call = "if (etiss_plugin_InstructionAccurateCallback_check(cpu, " + getPointerCode() +
+                                   ")) " + call;
                         etiss::CodePart &p = cs.append(etiss::CodePart::INITIALREQUIRED);
                         p.getRegisterDependencies().add("cpuTime_ps", 8);
-                        p.code() = std::string("etiss_plugin_InstructionAccurateCallback(") + getPointerCode() + ");";
+                        p.code() = call;
                         return true;
                     },
                     0);
@@ -90,9 +146,47 @@ std::string InstructionAccurateCallback::_getPluginName() const
     return std::string("InstructionAccurateCallback");
 }
 
+void *InstructionAccurateCallback::getPluginHandle()
+{
+    return (void *)&pluginData_;
+}
+
 void InstructionAccurateCallback::call()
 {
     plugin_core_->getStruct()->instructionAccurateCallback(plugin_cpu_->cpuTime_ps);
+    // fired triggers are removed and actions may add new ones
+    updateTriggerTable();
+}
+
+bool InstructionAccurateCallback::useTriggerTable() const
+{
+    if (!compiletriggers_)
+        return false;
+    std::shared_ptr<etiss::VirtualStruct> vs = plugin_core_->getStruct();
+    return vs && vs->structure_ == plugin_cpu_; // field offsets are relative to the cpu structure
+}
+
+void InstructionAccurateCallback::updateTriggerTable()
+{
+    if (!compiletriggers_)
+        return;
+    std::shared_ptr<etiss::VirtualStruct> vs = plugin_core_->getStruct();
+    if (!vs)
+        return;
+    const uint64_t generation = vs->getTriggerGeneration();
+    if (!tablevalid_ || generation != generation_)
+    {
+        vs->getTriggerTable(pluginData_.table_);
+        generation_ = generation;
+        tablevalid_ = true;
+    }
+}
+
+etiss::int32 InstructionAccurateCallback::execute()
+{
+    // triggers added by other plugins (e.g. etiss::fault::Stressor::addFault) apply from the next block on
+    updateTriggerTable();
+    return RETURNCODE::NOERROR;
 }
 
 } // namespace plugin
@@ -87,6 +87,7 @@ void BlockAccurateHandler::add(etiss::uint64 time_ps, unsigned errorid, std::str
     {
         next_time_ps = (etiss::uint64)(etiss::int64)-1;
     }
+    scheduleNext();
 }
 
 etiss::int32 BlockAccurateHandler::execute()
@@ -151,6 +152,7 @@ etiss::int32 BlockAccurateHandler::execute()
             next_time_ps = (etiss::uint64)(etiss::int64)-1;
         }
     }
+    scheduleNext();
 
     return etiss::RETURNCODE::NOERROR;
 }
@@ -233,6 +235,13 @@ void BlockAccurateHandler::parseFile(std::string filename, std::string reg)
     {
         next_time_ps = static_cast<etiss::uint64>(-1);
     }
+    scheduleNext();
+}
+
+void BlockAccurateHandler::scheduleNext()
+{
+    // errors are applied once the cpu time passed their time
+    scheduleAt(next_time_ps == (etiss::uint64)(etiss::int64)-1 ? EventQueue::NEVER : next_time_ps + 1);
 }
 
 std::string BlockAccurateHandler::_getPluginName() const
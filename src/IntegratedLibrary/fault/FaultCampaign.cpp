@@ -0,0 +1,411 @@
+/*
+
+        @copyright
+
+        <pre>
+
+        Copyright 2018 Infineon Technologies AG
+
+        This file is part of ETISS tool, see <https://github.com/tum-ei-eda/etiss>.
+
+        The initial version of this software has been created with the funding support by the German Federal
+        Ministry of Education and Research (BMBF) in the project EffektiV under grant 01IS13022.
+
+        Redistribution and use in source and binary forms, with or without modification, are permitted
+        provided that the following conditions are met:
+
+        1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+        the following disclaimer.
+
+        2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+        and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+        3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+        or promote products derived from this software without specific prior written permission.
+
+        THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+        WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+        PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+        DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+        PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+        HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+        NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+        POSSIBILITY OF SUCH DAMAGE.
+
+        </pre>
+
+        @author Chair of Electronic Design Automation, TUM
+
+        @version 0.1
+
+*/
+
+#include "etiss/IntegratedLibrary/fault/FaultCampaign.h"
+#include "etiss/CPUArch.h"
+#include "etiss/fault/Stressor.h"
+#include "etiss/jit/ReturnCode.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace etiss::plugin::fault;
+
+/// earliest cpu time at which a trigger may fire. 0 if the trigger depends on the simulated state
+static uint64_t earliestFiring(const etiss::fault::Trigger &t)
+{
+    switch (t.getType())
+    {
+    case etiss::fault::Trigger::TIME:
+        return t.getTriggerTime();
+    case etiss::fault::Trigger::META_COUNTER:
+        return earliestFiring(t.getSubTrigger());
+    default:
+        return 0;
+    }
+}
+
+static std::string hex(uint64_t value, int width)
+{
+    std::stringstream ss;
+    ss << "0x" << std::hex << std::setfill('0') << std::setw(width) << value;
+    return ss.str();
+}
+
+FaultCampaign::FaultCampaign(const std::string &xml, const std::string &result, unsigned workers, uint64_t sample_ps,
+                             uint64_t max_samples, unsigned timeout_factor)
+    : xml_(xml)
+    , result_(result)
+    , workers_(workers > 0 ? workers : 1)
+    , sample_ps_(sample_ps)
+    , max_samples_(max_samples > 0 ? max_samples : 1)
+    , timeout_factor_(timeout_factor)
+    , fork_ps_(0)
+    , last_ps_(0)
+    , role_(MAIN)
+    , fault_(nullptr)
+    , cpusize_(0)
+    , fd_(-1)
+    , golden_(nullptr)
+    , golden_size_(0)
+    , next_sample_(0)
+    , sample_index_(0)
+    , divergence_ps_(0)
+    , diverged_(false)
+    , timeout_ps_(0)
+    , timeout_s_(0)
+    , timedout_(false)
+{
+}
+
+FaultCampaign::~FaultCampaign()
+{
+    if (golden_)
+        munmap(golden_, golden_size_);
+    if (fd_ >= 0)
+        close(fd_);
+}
+
+void FaultCampaign::init(ETISS_CPU *cpu, ETISS_System *system, CPUArch *arch)
+{
+    cpusize_ = arch->getCPUStructSize();
+    if (cpusize_ == 0)
+    {
+        etiss::log(etiss::WARNING, "FaultCampaign: " + arch->getName() +
+                                       " doesn't report the size of its cpu structure. Only the registers of "
+                                       "ETISS_CPU are compared against the golden run.");
+        cpusize_ = sizeof(ETISS_CPU);
+    }
+    faults_.clear();
+    // a fork while a compile thread holds a lock of etiss::Translation leaves that lock held in the child forever
+    if (etiss::cfg().get<int>("jit.async.threads", 0) > 0)
+    {
+        etiss::log(etiss::ERROR, "FaultCampaign: the campaign is disabled because jit.async.threads is set. Forked "
+                                 "processes would deadlock on locks held by the background compile threads.");
+        return;
+    }
+
+    std::ifstream in(xml_.c_str());
+    if (!in.is_open())
+    {
+        etiss::log(etiss::ERROR, "FaultCampaign: failed to open fault file " + xml_);
+        return;
+    }
+    if (!etiss::fault::parseXML(faults_, in, std::cout))
+    {
+        etiss::log(etiss::ERROR, "FaultCampaign: failed to parse fault file " + xml_);
+        faults_.clear();
+        return;
+    }
+
+    // the golden run may proceed until the first fault can fire
+    fork_ps_ = (uint64_t)-1;
+    for (const auto &f : faults_)
+    {
+        if (f.triggers.empty())
+            fork_ps_ = 0;
+        for (const auto &t : f.triggers)
+            fork_ps_ = std::min(fork_ps_, earliestFiring(t));
+    }
+    last_ps_ = cpu->cpuTime_ps;
+    etiss::log(etiss::INFO, "FaultCampaign: " + etiss::toString(faults_.size()) + " faults loaded from " + xml_ +
+                                ". Earliest injection at " + etiss::toString(fork_ps_) + " ps.");
+}
+
+etiss::int32 FaultCampaign::execute()
+{
+    const uint64_t now = plugin_cpu_->cpuTime_ps;
+    if (role_ == MAIN)
+    {
+        if (faults_.empty())
+            return RETURNCODE::NOERROR;
+        // fork before the coroutine call that would pass the earliest injection point (assuming the next block takes
+        // as long as the previous one)
+        const uint64_t step = now - last_ps_;
+        last_ps_ = now;
+        if (now + step < fork_ps_)
+            return RETURNCODE::NOERROR;
+        if (now > fork_ps_)
+            etiss::log(etiss::WARNING, "FaultCampaign: workers are forked at " + etiss::toString(now) +
+                                           " ps. Faults triggered before that time are applied late.");
+        runCampaign();
+        if (role_ == MAIN)
+            return faults_.empty() ? RETURNCODE::NOERROR : RETURNCODE::CPUFINISHED;
+    }
+
+    sample();
+    if (role_ == WORKER && timeout_ps_ != 0 && now > timeout_ps_)
+    {
+        timedout_ = true;
+        return RETURNCODE::CPUFINISHED;
+    }
+    return RETURNCODE::NOERROR;
+}
+
+void FaultCampaign::executionEnd(int32_t code)
+{
+    if (role_ == MAIN)
+        return;
+
+    const uint64_t hash = hashState();
+    if (role_ == GOLDEN)
+    {
+        golden_->end_ps = plugin_cpu_->cpuTime_ps;
+        golden_->hash = hash;
+        golden_->code = code;
+        _exit(0);
+    }
+
+    const char *result = "masked";
+    if (timedout_)
+    {
+        result = "timeout";
+    }
+    else if (diverged_ || code != golden_->code || hash != golden_->hash)
+    {
+        result = "diverged";
+        if (!diverged_)
+            divergence_ps_ = plugin_cpu_->cpuTime_ps;
+        diverged_ = true;
+    }
+    writeResult(fault_, hex((uint32_t)code, 8), diverged_ ? etiss::toString(divergence_ps_) : std::string(),
+                hex(hash, 16), result);
+    _exit(0);
+}
+
+std::string FaultCampaign::_getPluginName() const
+{
+    return std::string("FaultCampaign");
+}
+
+uint64_t FaultCampaign::hashState() const
+{
+    // FNV-1a
+    const uint8_t *data = (const uint8_t *)plugin_cpu_;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < cpusize_; i++)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void FaultCampaign::sample()
+{
+    const uint64_t now = plugin_cpu_->cpuTime_ps;
+    if (now < next_sample_ || (role_ == WORKER && diverged_))
+        return;
+    next_sample_ = now + sample_ps_;
+    const uint64_t hash = hashState();
+    if (role_ == GOLDEN)
+    {
+        if (sample_index_ < max_samples_)
+        {
+            golden_->samples[sample_index_].time_ps = now;
+            golden_->samples[sample_index_].hash = hash;
+            golden_->count = sample_index_ + 1;
+        }
+    }
+    else if (sample_index_ < golden_->count)
+    {
+        const Sample &s = golden_->samples[sample_index_];
+        diverged_ = s.time_ps != now || s.hash != hash;
+    }
+    else
+    {
+        // running past the end of the golden run unless the golden trace was truncated
+        diverged_ = golden_->count < max_samples_;
+    }
+    if (diverged_)
+        divergence_ps_ = now;
+    sample_index_++;
+}
+
+void FaultCampaign::writeResult(const etiss::fault::Fault *fault, const std::string &code,
+                                const std::string &divergence, const std::string &hash, const char *result)
+{
+    std::stringstream ss;
+    if (fault)
+        ss << fault->id_ << ",\"" << fault->name_ << "\",";
+    else
+        ss << "-1,\"golden\",";
+    ss << code << "," << divergence << "," << hash << "," << result << "\n";
+    const std::string line = ss.str();
+    // a single write to a file opened with O_APPEND is not interleaved with lines of other workers
+    if (write(fd_, line.data(), line.size()) != (ssize_t)line.size())
+        etiss::log(etiss::ERROR, "FaultCampaign: failed to write to " + result_);
+}
+
+void FaultCampaign::reap(bool block)
+{
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, block ? 0 : WNOHANG);
+    if (pid <= 0)
+        return;
+    auto it = running_.find(pid);
+    if (it == running_.end())
+        return;
+    // workers that terminated regularly have written their own result line
+    if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM)
+        writeResult(it->second, std::string(), std::string(), std::string(), "timeout (wall clock)");
+    else if (WIFSIGNALED(status))
+        writeResult(it->second, std::string(), std::string(), std::string(),
+                    ("crashed (signal " + etiss::toString(WTERMSIG(status)) + ")").c_str());
+    else if (WIFEXITED(status) && WEXITSTATUS(status) != 0)
+        writeResult(it->second, std::string(), std::string(), std::string(),
+                    ("aborted (status " + etiss::toString(WEXITSTATUS(status)) + ")").c_str());
+    running_.erase(it);
+}
+
+void FaultCampaign::runCampaign()
+{
+    const uint64_t now = plugin_cpu_->cpuTime_ps;
+    const auto start = std::chrono::steady_clock::now();
+
+    golden_size_ = offsetof(Golden, samples) + max_samples_ * sizeof(Sample);
+    void *shared = mmap(nullptr, golden_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1,
+                        0);
+    if (shared == MAP_FAILED)
+    {
+        etiss::log(etiss::ERROR, "FaultCampaign: failed to map the golden trace. Continuing without campaign.");
+        faults_.clear();
+        return;
+    }
+    golden_ = (Golden *)shared;
+    fd_ = open(result_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd_ < 0)
+    {
+        etiss::log(etiss::ERROR, "FaultCampaign: failed to open result file " + result_ +
+                                     ". Continuing without campaign.");
+        faults_.clear();
+        return;
+    }
+    const std::string header("fault_id,fault_name,exit_code,divergence_ps,state_hash,result\n");
+    if (write(fd_, header.data(), header.size()) != (ssize_t)header.size())
+        etiss::log(etiss::ERROR, "FaultCampaign: failed to write to " + result_);
+
+    // buffered output would otherwise be printed by every child
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(nullptr);
+
+    next_sample_ = now;
+    sample_index_ = 0;
+
+    // golden reference run
+    const auto golden_start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        role_ = GOLDEN;
+        return;
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        etiss::log(etiss::ERROR, "FaultCampaign: golden run failed. Continuing without campaign.");
+        faults_.clear();
+        return;
+    }
+    writeResult(nullptr, hex((uint32_t)golden_->code, 8), std::string(), hex(golden_->hash, 16), "golden");
+    if (timeout_factor_ > 0)
+    {
+        timeout_ps_ = now + std::max<uint64_t>(golden_->end_ps - now, 1) * timeout_factor_;
+        // wall clock limit for workers that stop advancing the cpu time (e.g. a fault that leads to an endless loop
+        // in a plugin). at least 10 s to leave time for translating code the golden run didn't execute
+        const double golden_s =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - golden_start).count();
+        timeout_s_ = std::max(10u, (unsigned)(golden_s * timeout_factor_) + 1);
+    }
+
+    // one worker per fault
+    for (const auto &f : faults_)
+    {
+        while (running_.size() >= workers_)
+            reap(true);
+        pid = fork();
+        if (pid == 0)
+        {
+            role_ = WORKER;
+            fault_ = &f;
+            running_.clear();
+            // the output of the simulated program is not of interest for an experiment
+            int devnull = open("/dev/null", O_WRONLY);
+            if (devnull >= 0)
+            {
+                dup2(devnull, STDOUT_FILENO);
+                close(devnull);
+            }
+            etiss::fault::Stressor::addFault(f);
+            if (timeout_s_ > 0)
+                alarm(timeout_s_); // SIGALRM terminates the worker; reported by reap
+            return;
+        }
+        if (pid < 0)
+        {
+            etiss::log(etiss::ERROR, "FaultCampaign: failed to fork worker for fault", f);
+            continue;
+        }
+        running_[pid] = &f;
+    }
+    while (!running_.empty())
+        reap(true);
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::stringstream ss;
+    ss << "FaultCampaign: " << faults_.size() << " experiments with " << workers_ << " workers in " << seconds
+       << " s (" << (seconds > 0 ? faults_.size() * 3600.0 / seconds : 0.0) << " experiments/h). Results: "
+       << result_;
+    etiss::log(etiss::INFO, ss.str());
+}
@@ -50,6 +50,7 @@
 
 */
 #include "etiss/InterruptHandler.h"
+#include "etiss/EventQueue.h"
 
 using namespace etiss;
 
@@ -78,6 +79,7 @@ void InterruptHandler::setLine(unsigned line, bool state, etiss::uint64 time_ps)
     pending_.push_back(std::make_pair(time_ps, std::make_pair(line, state))); // add interrupt to list
     pending_.sort(interrupt_handler_cmp);
     empty_ = false;
+    scheduleAt(pending_.front().first);
     if (sync_)
         mu_.unlock();
 }
@@ -157,6 +159,8 @@ etiss::int32 InterruptHandler::execute()
 
         empty_ = pending_.empty();
     }
+    // wake up at the next pending change (only effective for edge triggered interrupts; see isEventDriven)
+    scheduleAt(pending_.empty() ? EventQueue::NEVER : pending_.front().first);
 
     if (sync_)
         mu_.unlock();
@@ -164,6 +168,58 @@ etiss::int32 InterruptHandler::execute()
     return (mayinterrupt && vector_->isActive()) ? etiss::RETURNCODE::INTERRUPT : etiss::RETURNCODE::NOERROR;
 }
 
+bool InterruptHandler::isEventDriven()
+{
+    // level triggered interrupts are signaled as long as the vector is active which may change without setLine
+    return itype_ == EDGE_TRIGGERED;
+}
+
+void InterruptHandler::saveState(std::vector<etiss::uint8> &state)
+{
+    // layout: number of pending changes, changes (time, line, state), raised lines
+    auto append = [&state](etiss::uint64 val) {
+        state.insert(state.end(), (etiss::uint8 *)&val, (etiss::uint8 *)&val + sizeof(val));
+    };
+    if (sync_)
+        mu_.lock();
+    state.clear();
+    append(pending_.size());
+    for (auto &change : pending_)
+    {
+        append(change.first);
+        append(change.second.first);
+        append(change.second.second);
+    }
+    for (unsigned line : ed_raised_)
+        append(line);
+    if (sync_)
+        mu_.unlock();
+}
+
+void InterruptHandler::restoreState(const std::vector<etiss::uint8> &state)
+{
+    const size_t count = state.size() / sizeof(etiss::uint64);
+    std::vector<etiss::uint64> vals(count);
+    memcpy(vals.data(), state.data(), count * sizeof(etiss::uint64));
+    if (state.size() % sizeof(etiss::uint64) != 0 || count == 0 || vals[0] > (count - 1) / 3)
+    {
+        etiss::log(etiss::ERROR, "InterruptHandler::restoreState: invalid state");
+        return;
+    }
+    if (sync_)
+        mu_.lock();
+    pending_.clear();
+    ed_raised_.clear();
+    size_t pos = 1;
+    for (etiss::uint64 i = 0; i < vals[0]; i++, pos += 3)
+        pending_.push_back(std::make_pair(vals[pos], std::make_pair((unsigned)vals[pos + 1], vals[pos + 2] != 0)));
+    for (; pos < count; pos++)
+        ed_raised_.insert((unsigned)vals[pos]);
+    empty_ = pending_.empty();
+    if (sync_)
+        mu_.unlock();
+}
+
 std::string InterruptHandler::_getPluginName() const
 {
     return "InterruptHandler";
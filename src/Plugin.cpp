@@ -51,6 +51,7 @@
 */
 
 #include "etiss/Plugin.h"
+#include "etiss/EventQueue.h"
 
 using namespace etiss;
 
@@ -103,13 +104,18 @@ std::string TranslationPlugin::getPointerCode() const
     return pointerCode;
 }
 
-CoroutinePlugin::CoroutinePlugin()
+CoroutinePlugin::CoroutinePlugin() : eventqueue_(nullptr)
 {
     this->type_ |= Plugin::COROUTINE;
     this->cplugin_ = this;
 }
 CoroutinePlugin::~CoroutinePlugin() {}
 void CoroutinePlugin::executionEnd(int32_t code) {}
+void CoroutinePlugin::scheduleAt(etiss::uint64 time_ps)
+{
+    if (eventqueue_)
+        eventqueue_->schedule(this, time_ps);
+}
 
 SystemWrapperPlugin::SystemWrapperPlugin()
 {
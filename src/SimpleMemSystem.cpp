@@ -53,14 +53,26 @@
 #include "etiss/SimpleMemSystem.h"
 #include "etiss/CPUArch.h"
 #include "etiss/Misc.h"
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <fstream>
 #include <unordered_map>
 
 #include "elfio/elfio.hpp"
+#include <chrono>
 #include <memory>
 
+#ifndef _WIN32
+#include <atomic>
+#include <mutex>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
 #define ARMv6M_DEBUG_PRINT 0
 #define MAX_MEMSEGS 99
 
@@ -76,10 +88,319 @@ uint32_t printMessage(std::string key, std::string message, uint32_t maxCount)
     return count;
 }
 
+namespace etiss
+{
+
+/// saved content of a memory segment (see MemSegment::checkpoint)
+struct MemSegmentCheckpoint
+{
+    std::vector<etiss::uint8> copy; ///< content of segments that are not saved copy-on-write
+    bool cow = false;
+    etiss::uint8 *mem = nullptr; ///< write protected memory
+    size_t size = 0;             ///< size of mem and saved; multiple of pagesize
+    size_t pagesize = 0;
+    etiss::uint8 *saved = nullptr;         ///< saved pages at their offset in mem
+    std::vector<etiss::uint8> savedpages;  ///< 1 if saved holds the page
+    std::vector<etiss::uint8> writtenpages; ///< 1 if the page was written since the checkpoint or last restore
+};
+
+} // namespace etiss
+
+#ifndef _WIN32
+
+/// maximum number of segments that are saved copy-on-write at the same time; others are copied
+#define MSEG_MAX_COW_CHECKPOINTS 256
+
+/// copy-on-write checkpoints that the SIGSEGV handler looks up; slots are 0 if unused
+static std::atomic<MemSegmentCheckpoint *> cow_checkpoints[MSEG_MAX_COW_CHECKPOINTS];
+static struct sigaction cow_previous_action;
+
+/// saves and unprotects a page of a checkpointed segment on the first write
+static void cow_fault(int sig, siginfo_t *info, void *context)
+{
+    etiss::uint8 *addr = (etiss::uint8 *)info->si_addr;
+    for (auto &slot : cow_checkpoints)
+    {
+        MemSegmentCheckpoint *cp = slot.load(std::memory_order_acquire);
+        if (cp == nullptr || addr < cp->mem || addr >= cp->mem + cp->size)
+            continue;
+        const size_t page = (size_t)(addr - cp->mem) / cp->pagesize;
+        etiss::uint8 *pagemem = cp->mem + page * cp->pagesize;
+        if (!cp->savedpages[page])
+        {
+            memcpy(cp->saved + page * cp->pagesize, pagemem, cp->pagesize);
+            cp->savedpages[page] = 1;
+        }
+        cp->writtenpages[page] = 1;
+        mprotect(pagemem, cp->pagesize, PROT_READ | PROT_WRITE);
+        return;
+    }
+    // not caused by a checkpoint
+    if (cow_previous_action.sa_flags & SA_SIGINFO)
+        cow_previous_action.sa_sigaction(sig, info, context);
+    else if (cow_previous_action.sa_handler != SIG_DFL && cow_previous_action.sa_handler != SIG_IGN)
+        cow_previous_action.sa_handler(sig);
+    else
+        sigaction(sig, &cow_previous_action, nullptr); // the access faults again with the default action
+}
+
+static bool register_cow_checkpoint(MemSegmentCheckpoint *cp)
+{
+    static std::once_flag installed;
+    std::call_once(installed, []() {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = &cow_fault;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &cow_previous_action);
+    });
+    for (auto &slot : cow_checkpoints)
+    {
+        MemSegmentCheckpoint *expected = nullptr;
+        if (slot.compare_exchange_strong(expected, cp))
+            return true;
+    }
+    return false;
+}
+
+static void unregister_cow_checkpoint(MemSegmentCheckpoint *cp)
+{
+    for (auto &slot : cow_checkpoints)
+    {
+        MemSegmentCheckpoint *expected = cp;
+        if (slot.compare_exchange_strong(expected, nullptr))
+            return;
+    }
+}
+
+#endif
+
+MemSegment::~MemSegment(void)
+{
+    discard_checkpoint();
+    if (self_allocated_ == true)
+        delete[] mem_;
+#ifndef _WIN32
+    if (mapped_size_ != 0)
+        munmap(mem_, mapped_size_);
+#endif
+}
+
+bool MemSegment::allocate_mapped()
+{
+#ifndef _WIN32
+    void *mem = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED)
+    {
+        etiss::log(etiss::WARNING, "MemSegment: mmap failed for " + name_ + "; allocating the memory on the heap");
+        return false;
+    }
+    mem_ = (etiss::uint8 *)mem;
+    mapped_size_ = size_;
+    return true;
+#else
+    return false;
+#endif
+}
+
+size_t MemSegment::map_file(const std::string &file, size_t offset, etiss::uint64 file_offset, size_t file_size_bytes)
+{
+#ifndef _WIN32
+    const size_t pagesize = (size_t)sysconf(_SC_PAGESIZE);
+    if (mapped_size_ == 0 || offset % pagesize != 0 || file_offset % pagesize != 0 ||
+        offset + file_size_bytes > size_)
+        return 0;
+    // bytes of a partial last page that follow the range in the file must not become visible
+    const size_t length = file_size_bytes - file_size_bytes % pagesize;
+    if (length == 0)
+        return 0;
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0)
+        return 0;
+    void *mem = mmap(mem_ + offset, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, (off_t)file_offset);
+    close(fd);
+    if (mem == MAP_FAILED)
+    {
+        // MAP_FIXED failures leave the range unmapped; restore the demand-zero pages
+        mmap(mem_ + offset, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+        return 0;
+    }
+    return length;
+#else
+    return 0;
+#endif
+}
+
+void MemSegment::checkpoint()
+{
+    discard_checkpoint();
+    checkpoint_ = new MemSegmentCheckpoint();
+#ifndef _WIN32
+    if (mapped_size_ != 0)
+    {
+        MemSegmentCheckpoint *cp = checkpoint_;
+        cp->pagesize = (size_t)sysconf(_SC_PAGESIZE);
+        cp->size = (mapped_size_ + cp->pagesize - 1) / cp->pagesize * cp->pagesize;
+        cp->savedpages.resize(cp->size / cp->pagesize, 0);
+        cp->writtenpages.resize(cp->size / cp->pagesize, 0);
+        void *saved = mmap(nullptr, cp->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (saved != MAP_FAILED)
+        {
+            cp->saved = (etiss::uint8 *)saved;
+            cp->mem = mem_;
+            if (register_cow_checkpoint(cp))
+            {
+                cp->cow = true;
+                mprotect(mem_, cp->size, PROT_READ);
+                return;
+            }
+            munmap(saved, cp->size);
+            cp->saved = nullptr;
+        }
+    }
+#endif
+    checkpoint_->copy.assign(mem_, mem_ + size_);
+}
+
+size_t MemSegment::restore()
+{
+    MemSegmentCheckpoint *cp = checkpoint_;
+    if (cp == nullptr)
+        return 0;
+    if (!cp->cow)
+    {
+        memcpy(mem_, cp->copy.data(), size_);
+        return size_;
+    }
+    size_t restored = 0;
+#ifndef _WIN32
+    for (size_t page = 0; page < cp->writtenpages.size(); ++page)
+    {
+        if (!cp->writtenpages[page])
+            continue;
+        memcpy(mem_ + page * cp->pagesize, cp->saved + page * cp->pagesize, cp->pagesize);
+        mprotect(mem_ + page * cp->pagesize, cp->pagesize, PROT_READ);
+        cp->writtenpages[page] = 0;
+        restored += cp->pagesize;
+    }
+#endif
+    return restored;
+}
+
+void MemSegment::discard_checkpoint()
+{
+    MemSegmentCheckpoint *cp = checkpoint_;
+    if (cp == nullptr)
+        return;
+#ifndef _WIN32
+    if (cp->cow)
+    {
+        mprotect(mem_, cp->size, PROT_READ | PROT_WRITE);
+        unregister_cow_checkpoint(cp);
+    }
+    if (cp->saved != nullptr)
+        munmap(cp->saved, cp->size);
+#endif
+    checkpoint_ = nullptr;
+    delete cp;
+}
+
+void SimpleMemSystem::checkpoint()
+{
+    for (auto &mseg : msegs_)
+        mseg->checkpoint();
+}
+
+void SimpleMemSystem::restore()
+{
+    size_t restored = 0;
+    for (auto &mseg : msegs_)
+        restored += mseg->restore();
+    std::stringstream msg;
+    msg << "SimpleMemSystem: restored " << restored << " bytes of memory from the checkpoint";
+    etiss::log(etiss::VERBOSE, msg.str());
+}
+
 void SimpleMemSystem::init_memory() {
+    auto begin = std::chrono::steady_clock::now();
     load_segments();
     load_elf();
-    std::sort(msegs_.begin(), msegs_.end(), [](std::unique_ptr<MemSegment> & a, std::unique_ptr<MemSegment> & b) {return a->start_addr_ < b->start_addr_;});
+    index_memsegments();
+    auto end = std::chrono::steady_clock::now();
+
+    std::stringstream msg;
+    msg << "SimpleMemSystem: initialized " << msegs_.size() << " memory segments in "
+        << std::chrono::duration<double, std::milli>(end - begin).count() << " ms";
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        msg << ", peak RSS " << usage.ru_maxrss / 1024 << " MiB"; // ru_maxrss is in KiB on Linux
+#endif
+    etiss::log(etiss::INFO, msg.str());
+}
+
+/// maximum number of entries of the page table of the segment lookup; the page size grows with the address range
+#define MSEG_MAX_PAGES (1 << 16)
+#define MSEG_PAGE_SHARED ((etiss::uint32)-1)
+
+void SimpleMemSystem::index_memsegments()
+{
+    std::stable_sort(msegs_.begin(), msegs_.end(), [](const std::unique_ptr<MemSegment> & a, const std::unique_ptr<MemSegment> & b) {return a->start_addr_ < b->start_addr_;});
+
+    mseg_starts_.clear();
+    mseg_pages_.clear();
+    msegs_overlap_ = false;
+    etiss::uint64 last = 0;
+    for (size_t i = 0; i < msegs_.size(); ++i) {
+        mseg_starts_.push_back(msegs_[i]->start_addr_);
+        if (i > 0 && msegs_[i]->start_addr_ <= msegs_[i - 1]->end_addr_)
+            msegs_overlap_ = true;
+        last = std::max(last, msegs_[i]->end_addr_);
+    }
+    if (msegs_.empty() || msegs_overlap_)
+        return;
+
+    // page table over the address range of all segments
+    mseg_pagebits_ = 12;
+    mseg_base_ = msegs_.front()->start_addr_ & ~(((etiss::uint64)1 << mseg_pagebits_) - 1);
+    while (((last - mseg_base_) >> mseg_pagebits_) >= MSEG_MAX_PAGES) {
+        ++mseg_pagebits_;
+        mseg_base_ = msegs_.front()->start_addr_ & ~(((etiss::uint64)1 << mseg_pagebits_) - 1);
+    }
+    mseg_pages_.resize(((last - mseg_base_) >> mseg_pagebits_) + 1, 0);
+    for (size_t i = 0; i < msegs_.size(); ++i) {
+        etiss::uint64 first = (msegs_[i]->start_addr_ - mseg_base_) >> mseg_pagebits_;
+        etiss::uint64 end = (msegs_[i]->end_addr_ - mseg_base_) >> mseg_pagebits_;
+        for (etiss::uint64 page = first; page <= end; ++page)
+            mseg_pages_[page] = mseg_pages_[page] == 0 ? (etiss::uint32)(i + 1) : MSEG_PAGE_SHARED;
+    }
+}
+
+MemSegment *SimpleMemSystem::find_mseg(etiss::uint64 addr, etiss::uint32 len)
+{
+    if (unlikely(msegs_overlap_)) {
+        auto it = std::find_if(msegs_.begin(), msegs_.end(), find_fitting_mseg(addr, len));
+        return it != msegs_.end() ? it->get() : nullptr;
+    }
+
+    // addresses below mseg_base_ wrap around and are outside of the table as well
+    const etiss::uint64 page = (addr - mseg_base_) >> mseg_pagebits_;
+    if (page >= mseg_pages_.size())
+        return nullptr;
+    const etiss::uint32 entry = mseg_pages_[page];
+    MemSegment *mseg;
+    if (likely(entry != MSEG_PAGE_SHARED)) {
+        if (entry == 0)
+            return nullptr;
+        mseg = msegs_[entry - 1].get();
+    } else {
+        auto it = std::upper_bound(mseg_starts_.begin(), mseg_starts_.end(), addr);
+        if (it == mseg_starts_.begin())
+            return nullptr;
+        mseg = msegs_[it - mseg_starts_.begin() - 1].get();
+    }
+    return mseg->payload_in_range(addr, len) ? mseg : nullptr;
 }
 
 void SimpleMemSystem::load_segments() {
@@ -128,8 +449,7 @@ void SimpleMemSystem::load_segments() {
                 << "[0x" << std::hex << std::setfill('0') << std::setw(sizeof(etiss::uint64) * 2) << origin + length - 1 << " - "
                 << "0x" << std::hex << std::setfill('0') << std::setw(sizeof(etiss::uint64) * 2) << origin << "]";
 
-            etiss::uint8 *buf = nullptr;
-            size_t fsize = 0;
+            auto mseg = std::make_unique<MemSegment>(origin, length, static_cast<MemSegment::access_t>(access), sname.str(), nullptr, mmap_);
 
             if (image != "")
             {
@@ -139,20 +459,30 @@ void SimpleMemSystem::load_segments() {
                     msg << "Error during read of segment image file " << image << "!";
                     etiss::log(etiss::FATALERROR, msg.str());
                 }
-                fsize = ifs.tellg();
-                ifs.seekg(0, std::ifstream::beg);
+                size_t fsize = ifs.tellg();
 
-                buf = new etiss::uint8[fsize];
+                // map the whole pages of the image and read only the rest
+                size_t mapped = mseg->map_file(image, 0, 0, fsize);
+                ifs.seekg(mapped, std::ifstream::beg);
 
-                ifs.read((char*)buf, fsize);
+                std::vector<etiss::uint8> buf(fsize - mapped);
+                ifs.read((char*)buf.data(), buf.size());
+                mseg->load(buf.data(), mapped, buf.size());
             }
 
-            auto mseg = std::make_unique<MemSegment>(origin, length, static_cast<MemSegment::access_t>(access), sname.str(), nullptr);
-            add_memsegment(mseg, buf, fsize);
+            add_memsegment(mseg, nullptr, 0);
         }
     }
 }
 
+/// loads the data of an ELF segment at offset of mseg; whole pages are mapped from the file if possible
+static void load_elf_segment(MemSegment &mseg, const std::string &elf_file, ELFIO::segment &seg, size_t offset)
+{
+    size_t file_size = seg.get_file_size();
+    size_t mapped = mseg.map_file(elf_file, offset, seg.get_offset(), file_size);
+    mseg.load(seg.get_data() + mapped, offset + mapped, file_size - mapped);
+}
+
 void SimpleMemSystem::load_elf()
 {
     if (!etiss::cfg().isSet("vp.elf_file")) return;
@@ -222,6 +552,8 @@ void SimpleMemSystem::load_elf()
         if (seg->get_flags() & PF_X) {
             mode |= MemSegment::EXEC;
             modestr += "X";
+            if (file_size > 0)
+                executable_ranges_.push_back(std::make_pair(start_addr, start_addr + file_size));
         }
 
         std::stringstream sname;
@@ -237,7 +569,7 @@ void SimpleMemSystem::load_elf()
             mseg->name_ = sname.str();
             mseg->mode_ = static_cast<MemSegment::access_t>(mode);
 
-            mseg->load(seg->get_data(), start_addr - mseg->start_addr_, file_size);
+            load_elf_segment(*mseg, elf_file, *seg, start_addr - mseg->start_addr_);
 
             std::stringstream msg;
             msg << "Initialized the memory segment " << mseg->name_ << " from ELF-file";
@@ -257,8 +589,9 @@ void SimpleMemSystem::load_elf()
             etiss::log(etiss::WARNING, msg.str());
         }
 
-        auto mseg = std::make_unique<MemSegment>(start_addr, size, static_cast<MemSegment::access_t>(mode), sname.str());
-        add_memsegment(mseg, seg->get_data(), file_size);
+        auto mseg = std::make_unique<MemSegment>(start_addr, size, static_cast<MemSegment::access_t>(mode), sname.str(), nullptr, mmap_);
+        load_elf_segment(*mseg, elf_file, *seg, 0);
+        add_memsegment(mseg, nullptr, 0);
     }
 
     // read start or rather program boot address from ELF
@@ -274,6 +607,7 @@ void SimpleMemSystem::add_memsegment(std::unique_ptr<MemSegment>& mseg, const vo
     mseg->load(raw_data, 0, file_size_bytes);
 
     msegs_.push_back(std::move(mseg));
+    index_memsegments();
 }
 
 SimpleMemSystem::SimpleMemSystem() :
@@ -281,6 +615,7 @@ SimpleMemSystem::SimpleMemSystem() :
     print_dbus_access_(etiss::cfg().get<bool>("simple_mem_system.print_dbus_access", false)),
     print_dbgbus_access_(etiss::cfg().get<bool>("simple_mem_system.print_dbgbus_access", false)),
     print_to_file_(etiss::cfg().get<bool>("simple_mem_system.print_to_file", false)),
+    mmap_(etiss::cfg().get<bool>("simple_mem_system.mmap", false)),
     error_on_seg_mismatch_(etiss::cfg().get<bool>("simple_mem_system.error_on_seg_mismatch", false)),
     message_max_cnt_(etiss::cfg().get<int>("simple_mem_system.message_max_cnt", 100))
 {
@@ -303,8 +638,7 @@ void access_error(ETISS_CPU *cpu, etiss::uint64 addr, etiss::uint32 len, std::st
 
 etiss::int32 SimpleMemSystem::iread(ETISS_CPU *cpu, etiss::uint64 addr, etiss::uint32 len)
 {
-    auto it = std::find_if(msegs_.begin(), msegs_.end(), find_fitting_mseg(addr, len));
-    if (it != msegs_.end()) return RETURNCODE::NOERROR;
+    if (find_mseg(addr, len) != nullptr) return RETURNCODE::NOERROR;
 
     access_error(cpu, addr, len, "ibus read error", etiss::ERROR);
     return RETURNCODE::IBUS_READ_ERROR;
@@ -335,10 +669,9 @@ static void trace(ETISS_CPU *cpu, etiss::uint64 addr, etiss::uint32 len, bool is
 
 template <bool write>
 etiss::int32 SimpleMemSystem::dbus_access(ETISS_CPU *cpu, etiss::uint64 addr, etiss::uint8 *buf, etiss::uint32 len) {
-    auto mseg_it = std::find_if(msegs_.begin(), msegs_.end(), find_fitting_mseg(addr, len));
+    MemSegment *mseg = find_mseg(addr, len);
 
-    if (mseg_it != msegs_.end()) {
-        auto & mseg = *mseg_it;
+    if (mseg != nullptr) {
         MemSegment::access_t access = write ? MemSegment::WRITE : MemSegment::READ;
 
         if (!(mseg->mode_ & access)) {
@@ -382,6 +715,27 @@ etiss::int32 SimpleMemSystem::dbg_write(etiss::uint64 addr, etiss::uint8 *buf, e
     return dwrite(nullptr, addr, buf, len);
 }
 
+const ETISS_DMIRange *SimpleMemSystem::getDMIRanges(etiss::uint32 &count)
+{
+    dmi_ranges_.clear();
+    if (!print_dbus_access_)
+    {
+        for (auto &mseg : msegs_)
+        {
+            // forbidden accesses are reported by dbus_access
+            etiss::uint32 flags = 0;
+            if (mseg->mode_ & MemSegment::READ)
+                flags |= ETISS_DMI_READ;
+            if (mseg->mode_ & MemSegment::WRITE)
+                flags |= ETISS_DMI_WRITE;
+            if (flags != 0)
+                dmi_ranges_.push_back({ mseg->mem_, mseg->start_addr_, mseg->end_addr_ + 1, flags });
+        }
+    }
+    count = (etiss::uint32)dmi_ranges_.size();
+    return dmi_ranges_.empty() ? nullptr : dmi_ranges_.data();
+}
+
 extern void global_sync_time(uint64 time_ps);
 void SimpleMemSystem::syncTime(ETISS_CPU *cpu)
 {
@@ -110,6 +110,10 @@ std::shared_ptr<ETISS_System> etiss::wrap(etiss::System *sys)
 
     ret->handle = (void *)sys;
 
+    etiss::uint32 dmicount = 0;
+    ret->dmi = sys->getDMIRanges(dmicount);
+    ret->dmi_count = dmicount;
+
     return std::shared_ptr<ETISS_System>(ret);
 }
 
@@ -41,6 +41,9 @@
 */
 
 #include "etiss/Translation.h"
+#include "etiss/ETISS.h"
+#include <algorithm>
+#include <chrono>
 #include <mutex>
 
 namespace etiss
@@ -53,8 +56,52 @@ BlockLink::BlockLink(etiss::uint64 start, etiss::uint64 end, ExecBlockCall execB
     next = 0;
     branch = 0;
     valid = true;
+    execcount = 0;
+    nextcount = 0;
+    branchcount = 0;
+    chain = 0;
+    pma = start;
+    size = 0;
+    referenced = true;
+    pretranslated = false;
+    entryend = end;
 }
 
+void BlockLink::setChainSlot(ETISS_BlockChainSlot &slot, BlockLink *bl)
+{
+    static_assert(sizeof(bool) == sizeof(etiss_uint8), "BlockLink::valid is accessed as etiss_uint8 by the JIT code");
+    if (bl == 0)
+    {
+        slot.function = 0;
+        slot.valid = 0;
+        slot.start = 0;
+        slot.end = 0;
+        return;
+    }
+    slot.start = bl->start;
+    slot.end = bl->entryend;
+    slot.valid = reinterpret_cast<const etiss_uint8 *>(&bl->valid);
+    slot.function = reinterpret_cast<ETISS_BlockFunction const *>(&bl->execBlock);
+}
+
+/// background compilation of a block by Translation::compileWorker
+struct Translation::CompileJob
+{
+    std::vector<BlockLink *> blocks; ///< hold a reference; only modified by the simulation thread
+    std::string code;
+    std::vector<std::string> functionnames;
+    std::set<std::string> headers;
+    std::set<std::string> libloc;
+    std::set<std::string> libs;
+    bool debug;
+    void *lib;
+    std::vector<ExecBlockCall> execBlocks;
+    bool chaining;
+    bool trace; ///< the function is a superblock of the (single) block
+    std::vector<ETISS_BlockChain *> chains;
+    std::string error;
+};
+
 BlockLink::~BlockLink()
 {
     if (next != 0)
@@ -106,6 +153,13 @@ static void call_finalizeCodeBlock_ul(etiss::TranslationPlugin **ca, CodeBlock &
     }
 }
 
+/// headers included by the code of every block
+static const char *const jitincludes = "#include \"etiss/jit/CPU.h\"\n"
+                                       "#include \"etiss/jit/System.h\"\n"
+                                       "#include \"etiss/jit/libresources.h\"\n"
+                                       "#include \"etiss/jit/ReturnCode.h\"\n"
+                                       "#include \"etiss/jit/libCSRCounters.h\"\n";
+
 static uint64_t genTranslationId()
 {
     static std::mutex mu;
@@ -126,6 +180,37 @@ Translation::Translation(std::shared_ptr<etiss::CPUArch> &arch, std::shared_ptr<
     , plugins_array_(0)
     , plugins_handle_array_(0)
     , mis_(0)
+    , batchsize_(1)
+    , tierthreshold_(0)
+    , promotedcount_(0)
+    , finishedpending_(false)
+    , stopworkers_(false)
+    , jitmu_(std::make_shared<std::mutex>())
+    , chainbudget_(0)
+    , chainbudgetmax_(1)
+    , chainlast_(nullptr)
+    , chaindeadline_(nullptr)
+    , physicaltags_(false)
+    , pagebits_(12)
+    , fetchpma_(0)
+    , codetracker_(nullptr)
+    , tracethreshold_(0)
+    , tracemaxblocks_(0)
+    , tracecount_(0)
+    , maxblocks_(0)
+    , maxbytes_(0)
+    , cachedbytes_(0)
+    , clockhand_(0)
+    , evictedcount_(0)
+    , retranslatedcount_(0)
+    , cacheregisters_(false)
+    , regcount_(0)
+    , deferstate_(false)
+    , singleentry_(false)
+    , directmemory_(false)
+    , compiledlibs_(0)
+    , compiledblocks_(0)
+    , compilens_(0)
 #if ETISS_TRANSLATOR_STAT
     , next_count_(0)
     , branch_count_(0)
@@ -138,7 +223,28 @@ Translation::Translation(std::shared_ptr<etiss::CPUArch> &arch, std::shared_ptr<
 
 Translation::~Translation()
 {
+    if (tierthreshold_ > 0)
+        etiss::log(etiss::INFO, "Tiered compilation: " + toString(promotedcount_) + " blocks recompiled with " +
+                                    jit_->getName());
+    if (tracethreshold_ > 0)
+        etiss::log(etiss::INFO, "Trace formation: " + toString(tracecount_) + " superblocks compiled");
+    if (maxblocks_ != 0 || maxbytes_ != 0)
+        etiss::log(etiss::INFO, "Code cache: " + toString(evictedcount_) + " blocks evicted, " +
+                                    toString(retranslatedcount_) + " evicted blocks translated again");
+    stopWorkers();
+    if (compiledlibs_ > 0)
+    {
+        const double seconds = compilens_ / 1e9;
+        std::stringstream ss;
+        ss << "Compilation: " << compiledblocks_ << " blocks in " << compiledlibs_ << " libraries, "
+           << seconds * 1e3 / compiledlibs_ << " ms per library, " << seconds * 1e3 / compiledblocks_
+           << " ms per block (" << (seconds > 0 ? compiledblocks_ / seconds : 0) << " blocks/s)";
+        etiss::log(etiss::INFO, ss.str());
+    }
+    dropColdJobs(true);
+    dropTraces(true);
     unloadBlocks(0, (uint64_t)((int64_t)-1));
+    clearClock();
     delete[] plugins_array_;
     delete[] plugins_handle_array_;
     delete mis_;
@@ -146,6 +252,10 @@ Translation::~Translation()
 
 void **Translation::init()
 {
+    stopWorkers();
+    dropColdJobs(true);
+    dropTraces(true);
+    clearClock();
     delete[] plugins_array_;
     plugins_array_ = 0;
     delete[] plugins_handle_array_;
@@ -257,9 +367,377 @@ void **Translation::init()
         plugins_finalizeCodeBlock_ = &(call_finalizeCodeBlock_ul);
     }
 
+    batchsize_ = std::max(1, etiss::cfg().get<int>("jit.batch_size", 1));
+    chainbudgetmax_ = std::max(1, etiss::cfg().get<int>("jit.chaining.budget", 1));
+    {
+        int threshold = etiss::cfg().get<int>("jit.trace.threshold", 0);
+        tracethreshold_ = threshold > 0 ? (etiss::uint32)threshold : 0;
+        tracemaxblocks_ = std::max(2, etiss::cfg().get<int>("jit.trace.max_blocks", 8));
+    }
+    deferstate_ = etiss::cfg().get<bool>("jit.defer_state_updates", false);
+    singleentry_ = etiss::cfg().get<bool>("jit.single_entry", false);
+    directmemory_ = etiss::cfg().get<bool>("jit.direct_memory", false);
+    cacheregisters_ = etiss::cfg().get<bool>("jit.cache_registers", false) &&
+                      arch_->getCachedRegisters(regaccess_, regtype_, regcount_);
+
+    // tiered/asynchronous compilation
+    int threads = etiss::cfg().get<int>("jit.async.threads", 0);
+    int threshold = etiss::cfg().get<int>("jit.tiering.threshold", 0);
+    tierthreshold_ = threshold > 0 ? (etiss::uint32)threshold : 0;
+    std::string fastjitname;
+    if (threads > 0 || tierthreshold_ > 0)
+    {
+        fastjitname = etiss::cfg().get<std::string>("jit.fast_type", "");
+        fastjit_ = fastjitname.empty() ? nullptr : etiss::getJIT(fastjitname);
+        if (!fastjit_)
+        {
+            etiss::log(etiss::WARNING, "jit.async.threads and jit.tiering.threshold require a valid jit.fast_type "
+                                       "(e.g. TCCJIT). Tiered and asynchronous compilation are disabled.");
+            tierthreshold_ = 0;
+        }
+    }
+
+    // a chained block calls its successor from the wrapper function. unless the compiler turns that call into a jump
+    // every chained block adds a stack frame
+    if (chainbudgetmax_ > 1)
+    {
+        std::set<std::string> headers, libloc, libs;
+        bool debug;
+        getJITParameters(headers, libloc, libs, debug);
+        if (!jit_->optimizesTailCalls(debug) || (fastjit_ && !fastjit_->optimizesTailCalls(debug)))
+        {
+            etiss::log(etiss::WARNING, "jit.chaining.budget is ignored: the used JIT compilers don't compile tail "
+                                       "calls as jumps (e.g. TCCJIT or jit.debug=true).");
+            chainbudgetmax_ = 1;
+        }
+    }
+
+    // fixed file global code of every block; passed to the jit as prelude
+    preludeparts_.clear();
+    preludeparts_.insert(jitincludes);
+    for (auto &it : jitExtHeaders())
+    {
+        if (it != "")
+            preludeparts_.insert("#include \"" + it + "\"\n");
+    }
+    if (chainbudgetmax_ > 1)
+        preludeparts_.insert("#include \"etiss/jit/BlockChain.h\"\n");
+    prelude_.clear();
+    for (auto &part : preludeparts_)
+        prelude_ += part;
+    jit_->setPrelude(prelude_);
+
+    maxblocks_ = (size_t)std::max(0, etiss::cfg().get<int>("jit.cache.max_blocks", 0));
+    maxbytes_ = etiss::cfg().get<uint64_t>("jit.cache.max_bytes", 0);
+
+    if (fastjit_)
+    {
+        fastjit_->setPrelude(prelude_);
+        stopworkers_ = false;
+        for (int i = 0; i < threads; i++)
+            workers_.push_back(std::thread(&Translation::compileWorker, this));
+        if (tierthreshold_ > 0)
+            etiss::log(etiss::INFO, "Tiered compilation: blocks run with " + fastjitname + " until executed " +
+                                        toString(tierthreshold_) + " times, then with " + jit_->getName() + " (" +
+                                        toString(threads) + " background threads).");
+        else
+            etiss::log(etiss::INFO, "Asynchronous compilation with " + toString(threads) + " threads. Blocks run with " +
+                                        fastjitname + " until " + jit_->getName() + " has compiled them.");
+    }
+
     return plugins_handle_array_;
 }
 
+void Translation::compileJob(CompileJob *job)
+{
+    std::unique_lock<std::mutex> jitlock(*jitmu_, std::defer_lock);
+    if (!jit_->isThreadSafe())
+        jitlock.lock();
+    job->lib = compile(jit_, job->code, job->functionnames.size(), job->headers, job->libloc, job->libs, job->error,
+                       job->debug);
+    if (job->lib != 0)
+    {
+        for (auto &functionname : job->functionnames)
+        {
+            job->execBlocks.push_back((ExecBlockCall)jit_->getFunction(job->lib, functionname, job->error));
+            std::string chainerror;
+            job->chains.push_back(
+                job->chaining ? (ETISS_BlockChain *)jit_->getFunction(job->lib, functionname + "_chain", chainerror)
+                              : nullptr);
+        }
+    }
+}
+
+void Translation::compileWorker()
+{
+    std::unique_lock<std::mutex> lock(jobmu_);
+    while (true)
+    {
+        jobcv_.wait(lock, [this]() { return stopworkers_ || !jobs_.empty(); });
+        if (stopworkers_)
+            return;
+        CompileJob *job = jobs_.front();
+        jobs_.pop_front();
+        lock.unlock();
+        compileJob(job);
+        lock.lock();
+        finishedjobs_.push_back(job);
+        finishedpending_.store(true, std::memory_order_relaxed);
+    }
+}
+
+void Translation::initChain(BlockLink *bl, ETISS_BlockChain *chain)
+{
+    chain->budget = &chainbudget_;
+    chain->last = &chainlast_;
+    chain->self = bl;
+    chain->deadline = chaindeadline_;
+    bl->chain = chain;
+    BlockLink::setChainSlot(chain->next, bl->next);
+    BlockLink::setChainSlot(chain->branch, bl->branch);
+}
+
+void Translation::queueJob(CompileJob *job)
+{
+    {
+        std::lock_guard<std::mutex> lock(jobmu_);
+        jobs_.push_back(job);
+    }
+    jobcv_.notify_one();
+}
+
+void Translation::promote(BlockLink *bl)
+{
+    auto entry = coldjobs_.find(bl);
+    if (entry == coldjobs_.end())
+        return;
+    CompileJob *job = entry->second;
+    for (BlockLink *jbl : job->blocks)
+        coldjobs_.erase(jbl);
+    promotedcount_ += job->blocks.size();
+    submitJob(job);
+}
+
+void Translation::submitJob(CompileJob *job)
+{
+    if (!workers_.empty())
+    {
+        queueJob(job);
+    }
+    else
+    {
+        // compile synchronously. the blocks are not executing and thus may be replaced immediately
+        compileJob(job);
+        {
+            std::lock_guard<std::mutex> lock(jobmu_);
+            finishedjobs_.push_back(job);
+        }
+        installCompiledBlocks();
+    }
+}
+
+void Translation::formTrace(BlockLink *head)
+{
+    if (physicaltags_ || traces_.find(head) != traces_.end())
+        return;
+
+    // follow the most frequently taken links as long as they were taken by the majority of executions
+    std::vector<BlockLink *> path;
+    path.push_back(head);
+    BlockLink *bl = head;
+    while (path.size() < tracemaxblocks_)
+    {
+        const bool takenext = bl->nextcount >= bl->branchcount;
+        BlockLink *succ = takenext ? bl->next : bl->branch;
+        const etiss::uint64 count = takenext ? bl->nextcount : bl->branchcount;
+        if (succ == 0 || !succ->valid || count * 2 <= bl->execcount)
+            break;
+        if (std::find(path.begin(), path.end(), succ) != path.end())
+            break; // loop back edge; handled by the links of head
+        path.push_back(succ);
+        bl = succ;
+    }
+    if (path.size() < 2)
+        return;
+
+    // the blocks are translated again as static functions; their code must cover the same range as before
+    std::stringstream code;
+    std::set<std::string> fileglobalcode;
+    beginCode(code, fileglobalcode);
+    std::vector<std::string> bodies;
+    for (BlockLink *pbl : path)
+    {
+        etiss::uint64 end;
+        std::string bodyname;
+        if (generateBlockCode(pbl->start, end, bodyname, code, fileglobalcode, true) != ETISS_RETURNCODE_NOERROR ||
+            end != pbl->end)
+            return;
+        bodies.push_back(bodyname);
+    }
+
+    std::string functionname;
+    {
+        std::stringstream ss;
+        ss << "_t" << id << "c" << tblockcount++ << "_trace_" << head->start;
+        functionname = ss.str();
+    }
+    const bool chaining = chainbudgetmax_ > 1; // BlockChain.h is part of the prelude
+    code << (chaining ? "static etiss_uint32 " + functionname + "_body" : "etiss_uint32 " + functionname)
+         << "(ETISS_CPU * const cpu, ETISS_System * const system, void * const * const plugin_pointers)\n{\n"
+         << "\tetiss_uint32 ret = " << bodies[0] << "(cpu, system, plugin_pointers);\n";
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        // side exit
+        code << "\tif (ret != ETISS_RETURNCODE_NOERROR || cpu->instructionPointer < " << path[i]->start
+             << "ULL || cpu->instructionPointer >= " << path[i]->entryend << "ULL) return ret;\n"
+             << "\tret = " << bodies[i] << "(cpu, system, plugin_pointers);\n";
+    }
+    code << "\treturn ret;\n}\n\n";
+    if (chaining)
+        writeChainFunction(code, functionname);
+
+    CompileJob *job = new CompileJob();
+    job->blocks.push_back(head);
+    BlockLink::incrRef(head); // job holds a reference
+    job->code = code.str();
+    job->functionnames.push_back(functionname);
+    getJITParameters(job->headers, job->libloc, job->libs, job->debug);
+    job->lib = 0;
+    job->chaining = chaining;
+    job->trace = true;
+
+    for (BlockLink *pbl : path)
+        BlockLink::incrRef(pbl); // trace holds a reference
+    traces_[head] = path;
+    tracecount_++;
+    submitJob(job);
+}
+
+void Translation::dropTraces(bool all)
+{
+    for (auto iter = traces_.begin(); iter != traces_.end();)
+    {
+        bool invalid = false;
+        for (BlockLink *bl : iter->second)
+            invalid |= !bl->valid;
+        if (all || invalid)
+        {
+            if (invalid)
+                iter->first->valid = false; // the superblock contains code of an invalidated block
+            for (BlockLink *bl : iter->second)
+                BlockLink::decrRef(bl);
+            iter = traces_.erase(iter);
+        }
+        else
+        {
+            iter++;
+        }
+    }
+}
+
+void Translation::dropColdJobs(bool all)
+{
+    std::set<CompileJob *> drop;
+    for (auto &entry : coldjobs_)
+    {
+        bool invalid = true;
+        for (BlockLink *jbl : entry.second->blocks)
+            invalid = invalid && !jbl->valid;
+        if (all || invalid)
+            drop.insert(entry.second);
+    }
+    for (CompileJob *job : drop)
+    {
+        for (BlockLink *jbl : job->blocks)
+        {
+            coldjobs_.erase(jbl);
+            BlockLink::decrRef(jbl);
+        }
+        delete job;
+    }
+}
+
+void Translation::installCompiledBlocks()
+{
+    std::vector<CompileJob *> jobs;
+    {
+        std::lock_guard<std::mutex> lock(jobmu_);
+        jobs.swap(finishedjobs_);
+        finishedpending_.store(false, std::memory_order_relaxed);
+    }
+    for (CompileJob *job : jobs)
+    {
+        if (job->lib != 0)
+        {
+            std::shared_ptr<void> lib = wrapLibrary(jitptr_, job->lib);
+            for (size_t i = 0; i < job->blocks.size(); i++)
+            {
+                BlockLink *bl = job->blocks[i];
+                if (job->execBlocks[i] != 0)
+                {
+                    // a superblock is not replaced by the recompiled code of its first block
+                    if (bl->valid && (job->trace || traces_.find(bl) == traces_.end()))
+                    {
+                        // the block isn't executing at this point; the old library is released with the last
+                        // reference
+                        bl->execBlock = job->execBlocks[i];
+                        bl->jitlib = lib;
+                        bl->chain = 0; // variable of the old library
+                        if (job->chains[i] != nullptr)
+                            initChain(bl, job->chains[i]);
+                    }
+                }
+                else
+                {
+                    etiss::log(etiss::WARNING,
+                               "Background compilation: failed to acquire function pointer: " + job->error);
+                }
+            }
+        }
+        else
+        {
+            etiss::log(etiss::WARNING, "Background compilation failed: " + job->error);
+        }
+        for (BlockLink *bl : job->blocks)
+            BlockLink::decrRef(bl);
+        delete job;
+    }
+}
+
+void Translation::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobmu_);
+        stopworkers_ = true;
+    }
+    jobcv_.notify_all();
+    for (auto &worker : workers_)
+        worker.join();
+    workers_.clear();
+    // drop queued jobs; finished jobs are installed to release their libraries
+    for (CompileJob *job : jobs_)
+    {
+        for (BlockLink *bl : job->blocks)
+            BlockLink::decrRef(bl);
+        delete job;
+    }
+    jobs_.clear();
+    finishedpending_.store(true, std::memory_order_relaxed);
+    installCompiledBlocks();
+}
+
+std::shared_ptr<void> Translation::wrapLibrary(std::shared_ptr<etiss::JIT> jit, void *handle)
+{
+    auto mu = jitmu_;
+    bool serialize = jit.get() == jit_ && !jit->isThreadSafe();
+    return std::shared_ptr<void>(handle, [jit, mu, serialize](void *p) {
+        std::unique_lock<std::mutex> lock(*mu, std::defer_lock);
+        if (serialize)
+            lock.lock();
+        jit->free(p);
+    });
+}
+
 BlockLink *Translation::getBlock(BlockLink *prev, const etiss::uint64 &instructionindex)
 {
 
@@ -270,6 +748,26 @@ BlockLink *Translation::getBlock(BlockLink *prev, const etiss::uint64 &instructi
         prev = 0;
     }
 
+    // exact start lookup; indirect branch targets usually hit here
+    {
+        BlockLink *bl = blocktable_.find(instructionindex);
+        if (bl != nullptr && bl->valid && matchesPhysical(bl, instructionindex, fetchpma_))
+        {
+            if (prev != 0)
+            {
+                if (prev->end == bl->start)
+                {
+                    prev->setNext(bl);
+                }
+                else
+                {
+                    prev->setBranch(bl);
+                }
+            }
+            return bl;
+        }
+    }
+
     // search block in cache
     std::list<BlockLink *> &list = blockmap_[instructionindex >> 9];
     for (std::list<BlockLink *>::iterator iter = list.begin(); iter != list.end();) // iter++ moved into block
@@ -279,17 +777,20 @@ BlockLink *Translation::getBlock(BlockLink *prev, const etiss::uint64 &instructi
         {
             if (iterbl->valid) // check for valid block
             {
-                if (iterbl->start <= instructionindex && iterbl->end > instructionindex)
+                if (iterbl->start <= instructionindex && iterbl->entryend > instructionindex &&
+                    matchesPhysical(iterbl, instructionindex, fetchpma_))
                 {
+                    if (physicaltags_ && iterbl->start == instructionindex)
+                        blocktable_.insert(instructionindex, iterbl); // e.g. after a context switch
                     if (prev != 0)
                     {
                         if (prev->end == iterbl->start)
                         {
-                            BlockLink::updateRef(prev->next, iterbl);
+                            prev->setNext(iterbl);
                         }
                         else
                         {
-                            BlockLink::updateRef(prev->branch, iterbl);
+                            prev->setBranch(iterbl);
                         }
                     }
                     return *iter;
@@ -298,8 +799,9 @@ BlockLink *Translation::getBlock(BlockLink *prev, const etiss::uint64 &instructi
             }
             else // cleanup
             {
-                BlockLink::updateRef(iterbl->next, 0);
-                BlockLink::updateRef(iterbl->branch, 0);
+                iterbl->setNext(0);
+                iterbl->setBranch(0);
+                blocktable_.erase(iterbl->start, iterbl);
                 list.erase(iter++);
                 BlockLink::decrRef(
                     iterbl); // remove reference of map // prev remains valid because this blocklink needs to be invalid
@@ -308,57 +810,231 @@ BlockLink *Translation::getBlock(BlockLink *prev, const etiss::uint64 &instructi
         }
     }
 
-    // generate block
+    // make room for the new blocks
+    if (unlikely(cacheExceeded()))
+    {
+        BlockLink *hold = prev;
+        if (hold != 0)
+            BlockLink::incrRef(hold); // the caller doesn't hold a reference
+        evictBlocks();
+        if (prev != 0 && !prev->valid)
+            prev = 0;
+        if (hold != 0)
+            BlockLink::decrRef(hold);
+    }
+
+    // generate block. with jit.batch_size > 1 the blocks following the requested block are translated
+    // speculatively and compiled into the same library
+    std::stringstream codestream;
+    std::set<std::string> fileglobalcode;
+    std::vector<etiss::uint64> starts;
+    std::vector<etiss::uint64> ends;
+    std::vector<std::string> functionnames;
+    std::vector<size_t> sizes; ///< generated code per block; charged to the code cache
+    beginCode(codestream, fileglobalcode);
 
-    std::string blockfunctionname;
     {
-        std::stringstream ss;
-        ss << "_t" << id << "c" << tblockcount++ << "_block_" << instructionindex;
-        blockfunctionname = ss.str();
+        etiss::uint64 end;
+        std::string blockfunctionname;
+        if (generateBlockCode(instructionindex, end, blockfunctionname, codestream, fileglobalcode) !=
+            ETISS_RETURNCODE_NOERROR)
+        {
+            etiss::log(etiss::ERROR, "Failed to translate block");
+            return nullptr;
+        }
+        starts.push_back(instructionindex);
+        ends.push_back(end);
+        functionnames.push_back(blockfunctionname);
+        sizes.push_back((size_t)codestream.tellp());
     }
 
-    CodeBlock block(instructionindex);
-    block.fileglobalCode().insert("#include \"etiss/jit/CPU.h\"\n"
-                                  "#include \"etiss/jit/System.h\"\n"
-                                  "#include \"etiss/jit/libresources.h\"\n"
-                                  "#include \"etiss/jit/ReturnCode.h\"\n"
-                                  "#include \"etiss/jit/libCSRCounters.h\"\n");
+    while (functionnames.size() < batchsize_)
+    {
+        etiss::uint64 start = ends.back();
+        if (physicaltags_ && ((start ^ instructionindex) >> pagebits_) != 0)
+            break; // physical address of the next page is unknown
+        etiss_uint8 probe;
+        if ((*system_.dbg_read)(system_.handle, start, &probe, 1) != etiss::RETURNCODE::NOERROR)
+            break; // no code to translate
+        if (findBlock(start, fetchpma_ + (start - instructionindex)) != nullptr)
+            break; // already translated
+        etiss::uint64 end;
+        std::string blockfunctionname;
+        const size_t pos = (size_t)codestream.tellp();
+        if (generateBlockCode(start, end, blockfunctionname, codestream, fileglobalcode) != ETISS_RETURNCODE_NOERROR)
+            break;
+        starts.push_back(start);
+        ends.push_back(end);
+        functionnames.push_back(blockfunctionname);
+        sizes.push_back((size_t)codestream.tellp() - pos);
+    }
 
-    for(auto &it: jitExtHeaders()){
-        if(it != "") block.fileglobalCode().insert("#include \"" + it + "\"\n");
+    std::string code = codestream.str();
+
+    std::set<std::string> headers;
+    std::set<std::string> libloc;
+    std::set<std::string> libs;
+    bool debug;
+    getJITParameters(headers, libloc, libs, debug);
+    /* DEBUG HELPER: write code files to work directory
+    {
+            static unsigned count = 0;
+            std::stringstream ss;
+            ss << "code" << ++count;
+            std::ofstream out;
+            out.open(ss.str().c_str());
+            out << code;
+            std::cout << "Code file " << count << std::endl;
     }
+    */
+    // with asynchronous compilation the block first runs with code of the fast jit
+    std::shared_ptr<etiss::JIT> firstjit = fastjit_ ? fastjit_ : jitptr_;
 
-    block.functionglobalCode().insert("if (cpu->mode != " + toString(cpu_.mode) +
-                                      ") return ETISS_RETURNCODE_RELOADCURRENTBLOCK;");
+    // compile library
+    void *funcs = compile(firstjit.get(), code, functionnames.size(), headers, libloc, libs, error, debug);
 
-    plugins_initCodeBlock_(plugins_array_, block);
+    if (funcs == 0)
+    {
+        etiss::log(etiss::ERROR, error);
+        return 0;
+    }
 
-    etiss::int32 transerror = translateBlock(block);
+    // wrap library handle for cleanup. all blocks of a batch share the library
+    std::shared_ptr<void> lib = wrapLibrary(firstjit, funcs);
 
-    if (transerror != ETISS_RETURNCODE_NOERROR)
+    // check function/library handle
+    if (lib.get() == 0)
+        return 0;
+
+    std::vector<BlockLink *> blocks;
+    for (size_t i = 0; i < functionnames.size(); i++)
     {
-        etiss::log(etiss::ERROR, "Failed to translate block");
-        return nullptr;
+        BlockLink *nbl = addBlock(firstjit, lib, functionnames[i], starts[i], ends[i],
+                                  fetchpma_ + (starts[i] - instructionindex), sizes[i]);
+        if (nbl == 0)
+        {
+            if (i == 0)
+                return 0;
+            break;
+        }
+        if (!blocks.empty())
+            blocks.back()->setNext(nbl); // batched blocks are consecutive
+        blocks.push_back(nbl);
     }
 
-    plugins_finalizeCodeBlock_(plugins_array_, block);
+    if (fastjit_)
+    {
+        // recompilation with jit_ starts immediately (asynchronous compilation) or once a block is hot (tiering)
+        CompileJob *job = new CompileJob();
+        for (auto bl : blocks)
+        {
+            job->blocks.push_back(bl);
+            BlockLink::incrRef(bl); // job holds a reference
+        }
+        job->code = code;
+        job->functionnames = functionnames;
+        job->functionnames.resize(blocks.size());
+        job->headers = headers;
+        job->libloc = libloc;
+        job->libs = libs;
+        job->debug = debug;
+        job->lib = 0;
+        job->chaining = chainbudgetmax_ > 1;
+        if (tierthreshold_ > 0)
+        {
+            for (auto bl : blocks)
+                coldjobs_[bl] = job;
+        }
+        else
+        {
+            queueJob(job);
+        }
+    }
 
-    std::string code;
+    BlockLink *nbl = blocks.front();
+    if (prev != 0)
     {
-        std::stringstream ss;
-        block.toCode(ss, blockfunctionname, nullptr);
-        code = ss.str();
+        if (nbl->start == prev->end)
+        {
+            prev->setNext(nbl);
+        }
+        else
+        {
+            prev->setBranch(nbl);
+        }
+    }
+    return nbl;
+}
+
+BlockLink *Translation::addBlock(std::shared_ptr<etiss::JIT> jit, std::shared_ptr<void> lib,
+                                 const std::string &functionname, etiss::uint64 start, etiss::uint64 end,
+                                 etiss::uint64 pma, size_t size)
+{
+    std::string error;
+    ExecBlockCall execBlock = (ExecBlockCall)jit->getFunction(lib.get(), functionname.c_str(), error);
+    if (execBlock == 0)
+    {
+        etiss::log(etiss::ERROR, std::string("Failed to acquire function pointer from compiled library:") + error);
+        return 0;
+    }
+    BlockLink *nbl = new BlockLink(start, end, execBlock, lib);
+    if (singleentry_)
+        nbl->entryend = start + 1; // other entries are translated as separate blocks on demand
+    if (physicaltags_)
+        nbl->pma = pma;
+    if (chainbudgetmax_ > 1)
+    {
+        std::string chainerror;
+        void *chain = jit->getFunction(lib.get(), functionname + "_chain", chainerror);
+        if (chain != 0)
+            initChain(nbl, (ETISS_BlockChain *)chain);
+    }
+    uint64 ii9 = start >> 9;
+    do
+    {
+        blockmap_[ii9].push_back(nbl);
+        BlockLink::incrRef(nbl); // map holds a reference
+        ii9++;
+    } while ((ii9 << 9) < end);
+    blocktable_.insert(start, nbl);
+    if (codetracker_)
+        codetracker_->addCode(start, end);
+    if (maxblocks_ != 0 || maxbytes_ != 0)
+    {
+        nbl->size = size;
+        cachedbytes_ += size;
+        clock_.push_back(nbl);
+        BlockLink::incrRef(nbl); // code cache holds a reference
+        if (evicted_.erase(start) != 0)
+            retranslatedcount_++;
     }
+    return nbl;
+}
 
+BlockLink *Translation::findBlock(const etiss::uint64 &instructionindex, etiss::uint64 pma)
+{
+    auto entry = blockmap_.find(instructionindex >> 9);
+    if (entry == blockmap_.end())
+        return nullptr;
+    for (BlockLink *bl : entry->second)
+    {
+        if (bl->valid && bl->start <= instructionindex && bl->entryend > instructionindex &&
+            matchesPhysical(bl, instructionindex, pma))
+            return bl;
+    }
+    return nullptr;
+}
+
+void Translation::getJITParameters(std::set<std::string> &headers, std::set<std::string> &libloc,
+                                   std::set<std::string> &libs, bool &debug)
+{
     // various includes
-    std::set<std::string> headers;
     headers.insert(etiss::jitFiles());
     headers.insert(arch_->getIncludePath());
     for(auto & it: jitExtHeaderPaths()){
        if(it != "") headers.insert(it);
     }
 
-    std::set<std::string> libloc;
     libloc.insert(arch_->getIncludePath());
     libloc.insert(etiss::cfg().get<std::string>("etiss_path", "./"));
     libloc.insert(etiss::jitFiles());
@@ -367,79 +1043,114 @@ BlockLink *Translation::getBlock(BlockLink *prev, const etiss::uint64 &instructi
        if(it != "") libloc.insert(etiss::jitFiles() + it);
     }
 
-    std::set<std::string> libs;
     //libs.insert("ETISS");
     libs.insert("resources");
     libs.insert("CSRCounters");
     for(auto & it: jitExtLibraries()){
        if(it != "") libs.insert(it);
     }
-    /* DEBUG HELPER: write code files to work directory
-    {
-            static unsigned count = 0;
-            std::stringstream ss;
-            ss << "code" << ++count;
-            std::ofstream out;
-            out.open(ss.str().c_str());
-            out << code;
-            std::cout << "Code file " << count << std::endl;
-    }
-    */
 #ifndef ETISS_DEBUG
 #define ETISS_DEBUG 1
 #endif
-    // compile library
-    void *funcs =
-        jit_->translate(code, headers, libloc, libs, error, etiss::cfg().get<bool>("jit.debug", ETISS_DEBUG) != 0);
+    debug = etiss::cfg().get<bool>("jit.debug", ETISS_DEBUG) != 0;
+}
 
-    if (funcs == 0)
+etiss::int32 Translation::generateBlockCode(const etiss::uint64 &instructionindex, etiss::uint64 &endindex,
+                                            std::string &functionname, std::stringstream &code,
+                                            std::set<std::string> &fileglobalcode, bool body)
+{
     {
-        etiss::log(etiss::ERROR, error);
-        return 0;
+        std::stringstream ss;
+        ss << "_t" << id << "c" << tblockcount++ << "_block_" << instructionindex;
+        functionname = ss.str();
     }
 
-    // wrap library handle for cleanup
-    auto local_jit = jit_;
-    std::shared_ptr<void> lib(funcs, [local_jit](void *p) { local_jit->free(p); });
+    CodeBlock block(instructionindex);
+    block.setSingleEntry(singleentry_);
+    block.fileglobalCode().insert(jitincludes);
 
-    // check function/library handle
-    if (lib.get() != 0)
+    for(auto &it: jitExtHeaders()){
+        if(it != "") block.fileglobalCode().insert("#include \"" + it + "\"\n");
+    }
+
+    block.functionglobalCode().insert("if (cpu->mode != " + toString(cpu_.mode) +
+                                      ") return ETISS_RETURNCODE_RELOADCURRENTBLOCK;");
+
+    plugins_initCodeBlock_(plugins_array_, block);
+
+    etiss::int32 transerror = translateBlock(block);
+
+    if (transerror != ETISS_RETURNCODE_NOERROR)
     {
-        // std::cout<<"blockfunctionname:"<<blockfunctionname<<std::endl;
-        ExecBlockCall execBlock = (ExecBlockCall)jit_->getFunction(lib.get(), blockfunctionname.c_str(), error);
-        if (execBlock != 0)
-        {
-            BlockLink *nbl = new BlockLink(block.startindex_, block.endaddress_, execBlock, lib);
-            uint64 ii9 = instructionindex >> 9;
-            do
-            {
-                blockmap_[ii9].push_back(nbl);
-                BlockLink::incrRef(nbl); // map holds a reference
-                ii9++;
-            } while ((ii9 << 9) < block.endaddress_);
+        return transerror;
+    }
 
-            if (prev != 0)
-            {
-                if (nbl->start == prev->end)
-                {
-                    BlockLink::updateRef(prev->next, nbl);
-                }
-                else
-                {
-                    BlockLink::updateRef(prev->branch, nbl);
-                }
-            }
-            return nbl;
-        }
-        else
-        {
-            etiss::log(etiss::ERROR, std::string("Failed to acquire function pointer from compiled library:") + error);
-            return 0;
-        }
+    plugins_finalizeCodeBlock_(plugins_array_, block);
+
+    if (deferstate_)
+        block.deferStateUpdates();
+    if (cacheregisters_)
+        block.cacheRegisters(regaccess_, regtype_, regcount_);
+    if (directmemory_)
+        block.useDirectMemory(); // calls still observe the cpu state if they fall back to dread/dwrite
+
+    const std::string params =
+        "(ETISS_CPU * const cpu, ETISS_System * const system, void * const * const plugin_pointers)";
+    if (body)
+    {
+        block.fileglobalCode().insert("static etiss_uint32 " + functionname + params + ";\n");
+        block.toCode(code, functionname, &fileglobalcode);
+    }
+    else if (chainbudgetmax_ > 1)
+    {
+        // the block is compiled as static function; the exported function continues with linked successors
+        const std::string bodyname = functionname + "_body";
+        block.fileglobalCode().insert("#include \"etiss/jit/BlockChain.h\"\n");
+        block.fileglobalCode().insert("static etiss_uint32 " + bodyname + params + ";\n");
+        block.toCode(code, bodyname, &fileglobalcode);
+        writeChainFunction(code, functionname);
     }
+    else
+    {
+        block.toCode(code, functionname, &fileglobalcode);
+    }
+    endindex = block.endaddress_;
 
-    return 0;
+    return ETISS_RETURNCODE_NOERROR;
 }
+
+void Translation::beginCode(std::stringstream &code, std::set<std::string> &fileglobalcode)
+{
+    code << prelude_;
+    fileglobalcode = preludeparts_;
+}
+
+void *Translation::compile(etiss::JIT *jit, const std::string &code, size_t blocks,
+                           const std::set<std::string> &headers, const std::set<std::string> &libloc,
+                           const std::set<std::string> &libs, std::string &error, bool debug)
+{
+    auto start = std::chrono::steady_clock::now();
+    void *lib = jit->translate(code, headers, libloc, libs, error, debug);
+    compilens_ += (etiss::uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    if (lib != 0)
+    {
+        compiledlibs_++;
+        compiledblocks_ += blocks;
+    }
+    return lib;
+}
+
+void Translation::writeChainFunction(std::stringstream &code, const std::string &functionname)
+{
+    code << "ETISS_BlockChain " << functionname << "_chain;\n"
+         << "etiss_uint32 " << functionname
+         << "(ETISS_CPU * const cpu, ETISS_System * const system, void * const * const plugin_pointers)\n{\n"
+         << "\treturn ETISS_BlockChain_continue(&" << functionname << "_chain, " << functionname
+         << "_body(cpu, system, plugin_pointers), cpu, system, plugin_pointers);\n}\n\n";
+}
+
 /// \note this function only does the instruction to C code translation. compilation (C code to function pointer) is
 /// done in getBlock()
 etiss::int32 Translation::translateBlock(CodeBlock &cb)
@@ -466,6 +1177,11 @@ etiss::int32 Translation::translateBlock(CodeBlock &cb)
 
     do
     {
+        // with physical tags a block ends at a page boundary
+        if (physicaltags_ && count > 0 && !context.force_append_next_instr_ &&
+            ((cb.endaddress_ ^ cb.startindex_) >> pagebits_) != 0)
+            break;
+
         context.force_append_next_instr_ = false;
         context.force_block_end_ = false;
         context.current_address_ = cb.endaddress_;
@@ -595,11 +1311,12 @@ void Translation::unloadBlocks(etiss::uint64 startindex, etiss::uint64 endindex)
             for (std::list<BlockLink *>::iterator iter = entry->second.begin(); iter != entry->second.end();)
             {
                 BlockLink *bl = *iter;
-                if (bl->start < endindex || bl->end > startindex)
+                if (bl->start < endindex && bl->end > startindex)
                 {
                     bl->valid = false;
-                    BlockLink::updateRef(bl->next, 0);
-                    BlockLink::updateRef(bl->branch, 0);
+                    bl->setNext(0);
+                    bl->setBranch(0);
+                    blocktable_.erase(bl->start, bl);
                     entry->second.erase(iter++);
                     BlockLink::decrRef(bl); // remove reference of map
                 }
@@ -612,6 +1329,234 @@ void Translation::unloadBlocks(etiss::uint64 startindex, etiss::uint64 endindex)
                 blockmap_.erase(entry);
         }
     }
+    if (!coldjobs_.empty())
+        dropColdJobs(false);
+    if (!traces_.empty())
+        dropTraces(false);
+}
+
+void Translation::removeBlock(BlockLink *bl)
+{
+    // the caller holds a reference
+    bl->valid = false;
+    bl->setNext(0);
+    bl->setBranch(0);
+    blocktable_.erase(bl->start, bl);
+    uint64 ii9 = bl->start >> 9;
+    do
+    {
+        auto entry = blockmap_.find(ii9);
+        if (entry != blockmap_.end())
+        {
+            auto iter = std::find(entry->second.begin(), entry->second.end(), bl);
+            if (iter != entry->second.end())
+            {
+                entry->second.erase(iter);
+                BlockLink *ref = bl;
+                BlockLink::decrRef(ref); // remove reference of map
+            }
+            if (entry->second.empty())
+                blockmap_.erase(entry);
+        }
+        ii9++;
+    } while ((ii9 << 9) < bl->end);
+}
+
+void Translation::evictBlocks()
+{
+    // forget blocks that have been invalidated otherwise
+    size_t keep = 0;
+    for (size_t i = 0; i < clock_.size(); i++)
+    {
+        BlockLink *bl = clock_[i];
+        if (bl->valid)
+        {
+            clock_[keep++] = bl;
+        }
+        else
+        {
+            cachedbytes_ -= bl->size;
+            BlockLink::decrRef(bl);
+        }
+    }
+    clock_.resize(keep);
+
+    // evict down to 7/8 of the budget to avoid evicting on every new block
+    const size_t targetblocks = maxblocks_ - maxblocks_ / 8;
+    const etiss::uint64 targetbytes = maxbytes_ - maxbytes_ / 8;
+    while (!clock_.empty() && ((maxblocks_ != 0 && clock_.size() > targetblocks) ||
+                               (maxbytes_ != 0 && cachedbytes_ > targetbytes)))
+    {
+        if (clockhand_ >= clock_.size())
+            clockhand_ = 0;
+        BlockLink *bl = clock_[clockhand_];
+        if (bl->referenced)
+        {
+            bl->referenced = false; // second chance
+            clockhand_++;
+            continue;
+        }
+        removeBlock(bl);
+        // other blocks may still link to bl but never call an invalid block. thus the library can be released now
+        // (unless other blocks of the batch use it); the chaining variable lives in that library
+        bl->chain = 0;
+        bl->jitlib.reset();
+        cachedbytes_ -= bl->size;
+        evicted_.insert(bl->start);
+        evictedcount_++;
+        clock_[clockhand_] = clock_.back();
+        clock_.pop_back();
+        BlockLink::decrRef(bl); // remove reference of the code cache
+    }
+
+    if (!coldjobs_.empty())
+        dropColdJobs(false);
+    if (!traces_.empty())
+        dropTraces(false);
+}
+
+void Translation::clearClock()
+{
+    for (BlockLink *bl : clock_)
+        BlockLink::decrRef(bl);
+    clock_.clear();
+    clockhand_ = 0;
+    cachedbytes_ = 0;
+}
+
+void Translation::invalidateWrittenCode()
+{
+    if (codetracker_ == nullptr)
+    {
+        unloadBlocks();
+        return;
+    }
+    const etiss::uint64 regionsize = ((etiss::uint64)1) << CodePageTracker::REGION_BITS;
+    for (etiss::uint64 start : codetracker_->takeWrittenRegions())
+    {
+        unloadBlocks(start, start + regionsize);
+    }
+}
+
+void Translation::pretranslate(const std::vector<std::pair<etiss::uint64, etiss::uint64>> &ranges)
+{
+    if (physicaltags_)
+    {
+        etiss::log(etiss::WARNING, "Pre-translation is not supported for cores with an MMU");
+        return;
+    }
+
+    struct Batch
+    {
+        std::string code;
+        std::vector<std::string> functionnames;
+        std::vector<etiss::uint64> starts;
+        std::vector<etiss::uint64> ends;
+        std::vector<size_t> sizes;
+        void *lib;
+        std::string error;
+    };
+
+    const size_t batchsize = (size_t)std::max(1, etiss::cfg().get<int>("jit.aot.batch_size", 64));
+    const auto starttime = std::chrono::steady_clock::now();
+
+    // linear sweep: each block starts where the previous one ended
+    std::vector<Batch> batches;
+    for (auto &range : ranges)
+    {
+        etiss::uint64 index = range.first;
+        std::stringstream code;
+        std::set<std::string> fileglobalcode;
+        beginCode(code, fileglobalcode);
+        Batch batch;
+        while (index < range.second)
+        {
+            etiss::uint64 end;
+            std::string functionname;
+            const size_t pos = (size_t)code.tellp();
+            if (generateBlockCode(index, end, functionname, code, fileglobalcode) != ETISS_RETURNCODE_NOERROR)
+                break; // the remaining code is translated on demand
+            batch.functionnames.push_back(functionname);
+            batch.starts.push_back(index);
+            batch.ends.push_back(end);
+            batch.sizes.push_back((size_t)code.tellp() - pos);
+            index = end;
+            if (batch.functionnames.size() >= batchsize || index >= range.second)
+            {
+                batch.code = code.str();
+                batches.push_back(std::move(batch));
+                batch = Batch();
+                std::stringstream().swap(code);
+                beginCode(code, fileglobalcode);
+            }
+        }
+        if (!batch.functionnames.empty())
+        {
+            batch.code = code.str();
+            batches.push_back(std::move(batch));
+        }
+    }
+    if (batches.empty())
+        return;
+
+    std::set<std::string> headers;
+    std::set<std::string> libloc;
+    std::set<std::string> libs;
+    bool debug;
+    getJITParameters(headers, libloc, libs, debug);
+
+    // compile the libraries in parallel
+    size_t threads = (size_t)std::max(1, etiss::cfg().get<int>("jit.aot.threads",
+                                                                (int)std::max(1u, std::thread::hardware_concurrency())));
+    if (!jit_->isThreadSafe())
+        threads = 1;
+    threads = std::min(threads, batches.size());
+    std::atomic<size_t> nextbatch(0);
+    auto compilebatches = [&]() {
+        for (size_t i = nextbatch++; i < batches.size(); i = nextbatch++)
+        {
+            Batch &batch = batches[i];
+            batch.lib =
+                compile(jit_, batch.code, batch.functionnames.size(), headers, libloc, libs, batch.error, debug);
+        }
+    };
+    std::vector<std::thread> compilers;
+    for (size_t i = 1; i < threads; i++)
+        compilers.push_back(std::thread(compilebatches));
+    compilebatches();
+    for (auto &compiler : compilers)
+        compiler.join();
+
+    size_t count = 0;
+    for (Batch &batch : batches)
+    {
+        if (batch.lib == 0)
+        {
+            etiss::log(etiss::WARNING, "Pre-translation: failed to compile library: " + batch.error);
+            continue;
+        }
+        std::shared_ptr<void> lib = wrapLibrary(jitptr_, batch.lib);
+        BlockLink *prev = 0;
+        for (size_t i = 0; i < batch.functionnames.size(); i++)
+        {
+            BlockLink *nbl = addBlock(jitptr_, lib, batch.functionnames[i], batch.starts[i], batch.ends[i],
+                                      batch.starts[i], batch.sizes[i]);
+            if (nbl == 0)
+                break;
+            nbl->pretranslated = true;
+            if (prev != 0)
+                prev->setNext(nbl);
+            prev = nbl;
+            count++;
+        }
+    }
+
+    const double seconds =
+        std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - starttime).count();
+    std::stringstream ss;
+    ss << "Pre-translation: " << count << " blocks compiled in " << batches.size() << " libraries with " << threads
+       << " threads (" << seconds << " s)";
+    etiss::log(etiss::INFO, ss.str());
 }
 
 std::string Translation::disasm(uint8_t *buf, unsigned len, int &append)
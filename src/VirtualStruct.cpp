@@ -42,6 +42,8 @@
 
 #include "etiss/VirtualStruct.h"
 
+#include <sstream>
+
 namespace etiss
 {
 
@@ -186,6 +188,11 @@ bool VirtualStruct::Field::applyAction(const etiss::fault::Fault &f, const etiss
     return _applyAction(f, a, errormsg);
 }
 
+const void *VirtualStruct::Field::getPointer() const
+{
+    return nullptr;
+}
+
 uint64_t VirtualStruct::Field::_read() const
 {
     throw std::runtime_error("VirtualStruct::Field::_read called but not implemented");
@@ -445,6 +452,20 @@ void *VirtualStruct::fastFieldAccessPtr(const std::string &name, std::string &er
     }
     return 0;
 }
+bool VirtualStruct::getFieldOffset(const std::string &name, uint64_t &offset, uint64_t &width)
+{
+    std::string errormsg;
+    Field *f = (Field *)fastFieldAccessPtr(name, errormsg);
+    if (!f || !(f->flags_ & Field::R))
+        return false;
+    const void *ptr = f->getPointer();
+    if (!ptr || (f->width_ != 1 && f->width_ != 2 && f->width_ != 4 && f->width_ != 8))
+        return false;
+    // the structure of a cpu core is accessible as "cpu" in translated code
+    offset = (const char *)ptr - (const char *)structure_;
+    width = f->width_;
+    return true;
+}
 bool VirtualStruct::readField(void *fastfieldaccessptr, uint64_t &val, std::string &errormsg)
 {
     Field *f = (Field *)fastfieldaccessptr;
@@ -0,0 +1,130 @@
+/*
+
+        @copyright
+
+        <pre>
+
+        Copyright 2018 Infineon Technologies AG
+
+        This file is part of ETISS tool, see <https://github.com/tum-ei-eda/etiss>.
+
+        The initial version of this software has been created with the funding support by the German Federal
+        Ministry of Education and Research (BMBF) in the project EffektiV under grant 01IS13022.
+
+        Redistribution and use in source and binary forms, with or without modification, are permitted
+        provided that the following conditions are met:
+
+        1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+        the following disclaimer.
+
+        2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+        and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+        3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+        or promote products derived from this software without specific prior written permission.
+
+        THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+        WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+        PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+        DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+        PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+        HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+        NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+        POSSIBILITY OF SUCH DAMAGE.
+
+        </pre>
+
+        @author Chair of Electronic Design Automation, TUM
+
+        @version 0.1
+
+*/
+
+#ifndef ETISS_BARE_ETISS_PROCESSOR_REPLAY_H_
+#define ETISS_BARE_ETISS_PROCESSOR_REPLAY_H_
+
+#include <chrono>
+#include <iostream>
+
+#include "etiss/ETISS.h"
+#include "etiss/EventQueue.h"
+#include "etiss/SimpleMemSystem.h"
+
+/**
+ * @brief Runs the section of a simulation between two cpu times repeatedly.
+ *        The state of the cpu, the plugins and the memory is saved with
+ *        etiss::CPUCore::checkpoint and etiss::SimpleMemSystem::checkpoint
+ *        once the cpu time reaches start_ps and restored whenever it reaches
+ *        end_ps. The translated code stays loaded, so every run after the
+ *        first one measures warm execution.
+ *
+ * @param runs: number of repetitions after the first run. afterwards the
+ *              simulation continues normally
+ */
+class Replay : public etiss::CoroutinePlugin
+{
+  public:
+    Replay(etiss::CPUCore &core, etiss::SimpleMemSystem &mem, etiss::uint64 start_ps, etiss::uint64 end_ps,
+           unsigned runs)
+        : core_(core), mem_(mem), start_ps_(start_ps), end_ps_(end_ps), runs_(runs)
+    {
+    }
+
+    bool isEventDriven() { return true; }
+
+    etiss::int32 execute()
+    {
+        if (!checkpoint_)
+        {
+            if (plugin_cpu_->cpuTime_ps < start_ps_)
+            {
+                scheduleAt(start_ps_);
+                return etiss::RETURNCODE::NOERROR;
+            }
+            if (!core_.checkpoint()) // error is logged by the core
+            {
+                scheduleAt(etiss::EventQueue::NEVER);
+                return etiss::RETURNCODE::NOERROR;
+            }
+            mem_.checkpoint();
+            checkpoint_ = true;
+            begin_ = std::chrono::steady_clock::now();
+            scheduleAt(end_ps_);
+            return etiss::RETURNCODE::NOERROR;
+        }
+        if (run_ > runs_ || plugin_cpu_->cpuTime_ps < end_ps_)
+        {
+            scheduleAt(run_ > runs_ ? etiss::EventQueue::NEVER : end_ps_);
+            return etiss::RETURNCODE::NOERROR;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        std::cout << "[INFO] {Replay} : run " << run_ << " took "
+                  << std::chrono::duration<double>(end - begin_).count() << " s" << std::endl;
+        if (run_++ == runs_)
+        {
+            scheduleAt(etiss::EventQueue::NEVER);
+            return etiss::RETURNCODE::NOERROR;
+        }
+        core_.restore();
+        mem_.restore();
+        begin_ = std::chrono::steady_clock::now();
+        scheduleAt(end_ps_);
+        return etiss::RETURNCODE::NOERROR;
+    }
+
+    std::string _getPluginName() const { return std::string("Replay"); }
+
+  private:
+    etiss::CPUCore &core_;
+    etiss::SimpleMemSystem &mem_;
+    const etiss::uint64 start_ps_;
+    const etiss::uint64 end_ps_;
+    const unsigned runs_;
+
+    bool checkpoint_ = false;
+    unsigned run_ = 0;
+    std::chrono::steady_clock::time_point begin_;
+};
+
+#endif
@@ -40,6 +40,7 @@
 
 */
 
+#include "Replay.h"
 #include "TracePrinter.h"
 #include "etiss/SimpleMemSystem.h"
 #include "etiss/ETISS.h"
@@ -107,6 +108,10 @@ int main(int argc, const char *argv[])
     // disable timer plugin
     cpu->setTimer(false);
 
+    // executable segments of the ELF file may be translated ahead of execution (jit.pretranslate)
+    for (auto &range : dsys.getExecutableRanges())
+        cpu->addPretranslationRange(range.first, range.second);
+
     // reset CPU with a manual start address
     cpu->reset(&sa);
 
@@ -128,6 +133,12 @@ int main(int argc, const char *argv[])
       etiss::cfg().set<int>("etiss.max_block_size", 1);
       cpu->addPlugin(std::shared_ptr<etiss::Plugin>(new TracePrinter(0x88888)));
     }
+    // repeat a section of the simulation from a checkpoint
+    if (etiss::cfg().isSet("vp.replay.end_ps")) {
+      cpu->addPlugin(std::shared_ptr<etiss::Plugin>(new Replay(
+          *cpu, dsys, etiss::cfg().get<uint64_t>("vp.replay.start_ps", 0),
+          etiss::cfg().get<uint64_t>("vp.replay.end_ps", 0), etiss::cfg().get<int>("vp.replay.runs", 1))));
+    }
 
     std::cout << "=== Setting up plug-ins ===" << std::endl << std::endl;
 
@@ -174,6 +185,7 @@ int main(int argc, const char *argv[])
         break;
         case etiss::RETURNCODE::GENERALERROR:
         case etiss::RETURNCODE::RELOADBLOCKS:
+        case etiss::RETURNCODE::RELOADALLBLOCKS:
         case etiss::RETURNCODE::RELOADCURRENTBLOCK:
         case etiss::RETURNCODE::BREAKPOINT:
         case etiss::RETURNCODE::ARCHERROR:
@@ -0,0 +1,166 @@
+/*
+
+        @copyright
+
+        <pre>
+
+        Copyright 2018 Infineon Technologies AG
+
+        This file is part of ETISS tool, see <https://github.com/tum-ei-eda/etiss>.
+
+        The initial version of this software has been created with the funding support by the German Federal
+        Ministry of Education and Research (BMBF) in the project EffektiV under grant 01IS13022.
+
+        Redistribution and use in source and binary forms, with or without modification, are permitted
+        provided that the following conditions are met:
+
+        1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+        the following disclaimer.
+
+        2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+        and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+        3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+        or promote products derived from this software without specific prior written permission.
+
+        THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+        WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+        PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+        DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+        PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+        HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+        NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+        POSSIBILITY OF SUCH DAMAGE.
+
+        </pre>
+
+        @author Chair of Electronic Design Automation, TUM
+
+        @version 0.1
+
+*/
+/**
+        @file
+
+        @brief microbenchmark of block lookups by instruction index
+
+        @detail compares the lookup of etiss::Translation before etiss::BlockLookupTable (hash map of 512 byte
+   buckets with a list of blocks per bucket) with etiss::BlockLookupTable for random block starts (misses of the
+   next/branch chain) and for a small set of hot targets (indirect branches/returns).
+
+        usage: benchmark_blocklookup [blocks] [lookups]
+
+*/
+
+#include "etiss/BlockLookupTable.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+struct Block
+{
+    etiss::uint64 start;
+    etiss::uint64 end;
+    bool valid;
+};
+
+/// block lookup as done by etiss::Translation::getBlock before the lookup table was added
+class LegacyBlockMap
+{
+  public:
+    void insert(Block *bl)
+    {
+        etiss::uint64 ii9 = bl->start >> 9;
+        do
+        {
+            map_[ii9].push_back(bl);
+            ii9++;
+        } while ((ii9 << 9) < bl->end);
+    }
+    Block *find(etiss::uint64 index)
+    {
+        std::list<Block *> &list = map_[index >> 9];
+        for (Block *bl : list)
+        {
+            if (bl->valid && bl->start <= index && bl->end > index)
+                return bl;
+        }
+        return nullptr;
+    }
+
+  private:
+    std::unordered_map<etiss::uint64, std::list<Block *>> map_;
+};
+
+template <typename F>
+double measure(const std::vector<etiss::uint64> &targets, F find, size_t &hits)
+{
+    auto begin = std::chrono::steady_clock::now();
+    for (etiss::uint64 t : targets)
+    {
+        if (find(t) != nullptr)
+            hits++;
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / targets.size();
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    size_t blockcount = argc > 1 ? std::strtoul(argv[1], nullptr, 0) : 20000;
+    size_t lookups = argc > 2 ? std::strtoul(argv[2], nullptr, 0) : 10000000;
+
+    // consecutive blocks of 4 to 64 byte at a typical RAM base address
+    std::mt19937_64 rng(42);
+    std::vector<Block> blocks(blockcount);
+    etiss::uint64 addr = 0x80000000;
+    for (auto &bl : blocks)
+    {
+        bl.start = addr;
+        addr += 4 * (1 + rng() % 16);
+        bl.end = addr;
+        bl.valid = true;
+    }
+
+    LegacyBlockMap legacy;
+    etiss::BlockLookupTable<Block> table;
+    for (auto &bl : blocks)
+    {
+        legacy.insert(&bl);
+        table.insert(bl.start, &bl);
+    }
+
+    std::vector<etiss::uint64> random(lookups);
+    for (auto &t : random)
+        t = blocks[rng() % blockcount].start;
+    std::vector<etiss::uint64> hot(lookups);
+    for (auto &t : hot)
+        t = blocks[rng() % 16].start;
+
+    size_t hits = 0;
+    auto legacyfind = [&legacy](etiss::uint64 i) { return legacy.find(i); };
+    auto tablefind = [&table](etiss::uint64 i) { return table.find(i); };
+
+    std::cout << blockcount << " blocks, " << lookups << " lookups" << std::endl;
+    std::cout << "random targets: legacy " << measure(random, legacyfind, hits) << " ns, table "
+              << measure(random, tablefind, hits) << " ns per lookup" << std::endl;
+    std::cout << "16 hot targets: legacy " << measure(hot, legacyfind, hits) << " ns, table "
+              << measure(hot, tablefind, hits) << " ns per lookup" << std::endl;
+
+    if (hits != lookups * 4)
+    {
+        std::cout << "ERROR: lookup failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+/*
+
+        @copyright
+
+        <pre>
+
+        Copyright 2018 Infineon Technologies AG
+
+        This file is part of ETISS tool, see <https://github.com/tum-ei-eda/etiss>.
+
+        The initial version of this software has been created with the funding support by the German Federal
+        Ministry of Education and Research (BMBF) in the project EffektiV under grant 01IS13022.
+
+        Redistribution and use in source and binary forms, with or without modification, are permitted
+        provided that the following conditions are met:
+
+        1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+        the following disclaimer.
+
+        2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+        and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+        3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+        or promote products derived from this software without specific prior written permission.
+
+        THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+        WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+        PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+        DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+        PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+        HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+        NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+        POSSIBILITY OF SUCH DAMAGE.
+
+        </pre>
+
+        @author Chair of Electronic Design Automation, TUM
+
+        @version 0.1
+
+*/
+/**
+        @file
+
+        @brief microbenchmark and check of the checkpoints of etiss::SimpleMemSystem
+
+        @detail measures SimpleMemSystem::checkpoint and SimpleMemSystem::restore of a heap allocated and a mmap
+   allocated (copy-on-write) segment for an increasing number of pages written after the checkpoint, and checks that
+   every restore yields the memory of the checkpoint. it also checks that the state saved by the InterruptHandler
+   (see Plugin::saveState) survives a restore.
+
+        usage: benchmark_checkpoint [segment size] [restores per measurement]
+
+*/
+
+#include "etiss/InterruptHandler.h"
+#include "etiss/SimpleMemSystem.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+class TestVector : public etiss::InterruptVector
+{
+  public:
+    void setBit(unsigned bit, bool state) { bits_[bit] = state; }
+    bool getBit(unsigned bit) const { return bits_[bit]; }
+    unsigned width() const { return 32; }
+
+  private:
+    bool bits_[32] = { false };
+};
+
+/// @return true if the pending line changes of an InterruptHandler are restored
+bool checkInterruptHandler()
+{
+    TestVector vector;
+    etiss::InterruptHandler handler(&vector, nullptr);
+    handler.setLine(3, true, 100);
+    handler.setLine(3, false, 200);
+    std::vector<etiss::uint8> saved;
+    handler.saveState(saved);
+    handler.setLine(5, true, 50);
+    handler.restoreState(saved);
+    std::vector<etiss::uint8> restored;
+    handler.saveState(restored);
+    return saved == restored;
+}
+
+double elapsed_us(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    size_t size = argc > 1 ? std::strtoul(argv[1], nullptr, 0) : 64 * 1024 * 1024;
+    size_t restores = argc > 2 ? std::strtoul(argv[2], nullptr, 0) : 10;
+    const size_t pagesize = 4096;
+    const etiss::uint64 base = 0x80000000;
+    const auto mode = static_cast<etiss::MemSegment::access_t>(etiss::MemSegment::READ | etiss::MemSegment::WRITE);
+
+    size_t errors = 0;
+    if (!checkInterruptHandler())
+    {
+        std::cout << "ERROR: InterruptHandler state differs after the restore" << std::endl;
+        errors++;
+    }
+
+    std::cout << "memory; written pages; checkpoint [us]; restore [us]" << std::endl;
+    for (bool mapped : { false, true })
+    {
+        etiss::SimpleMemSystem sys;
+        auto mseg = std::make_unique<etiss::MemSegment>(base, size, mode, "", nullptr, mapped);
+        sys.add_memsegment(mseg, nullptr, 0);
+
+        std::mt19937_64 rng(42);
+        std::vector<etiss::uint8> content(size);
+        for (auto &byte : content)
+            byte = (etiss::uint8)rng();
+        sys.dbg_write(base, content.data(), size);
+
+        auto begin = std::chrono::steady_clock::now();
+        sys.checkpoint();
+        const double checkpoint_us = elapsed_us(begin);
+
+        std::vector<etiss::uint8> readback(size);
+        for (size_t pages = 1; pages <= size / pagesize; pages *= 16)
+        {
+            double restore_us = 0;
+            for (size_t run = 0; run < restores; run++)
+            {
+                // overwrite one word of randomly chosen pages
+                for (size_t i = 0; i < pages; i++)
+                {
+                    etiss::uint8 word[4] = { 0xde, 0xad, 0xbe, 0xef };
+                    sys.dbg_write(base + (rng() % (size / pagesize)) * pagesize + (rng() % (pagesize / 4)) * 4, word, 4);
+                }
+                begin = std::chrono::steady_clock::now();
+                sys.restore();
+                restore_us += elapsed_us(begin);
+
+                sys.dbg_read(base, readback.data(), size);
+                if (readback != content)
+                    errors++;
+            }
+            std::cout << (mapped ? "mmap" : "heap") << "; " << pages << "; " << checkpoint_us << "; "
+                      << restore_us / restores << std::endl;
+        }
+    }
+
+    if (errors != 0)
+    {
+        std::cout << "ERROR: " << errors << " restores differ from the checkpoint" << std::endl;
+        return 1;
+    }
+    return 0;
+}
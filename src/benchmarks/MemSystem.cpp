@@ -0,0 +1,144 @@
+/*
+
+        @copyright
+
+        <pre>
+
+        Copyright 2018 Infineon Technologies AG
+
+        This file is part of ETISS tool, see <https://github.com/tum-ei-eda/etiss>.
+
+        The initial version of this software has been created with the funding support by the German Federal
+        Ministry of Education and Research (BMBF) in the project EffektiV under grant 01IS13022.
+
+        Redistribution and use in source and binary forms, with or without modification, are permitted
+        provided that the following conditions are met:
+
+        1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+        the following disclaimer.
+
+        2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+        and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+        3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+        or promote products derived from this software without specific prior written permission.
+
+        THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+        WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+        PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY
+        DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+        PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+        HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+        NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+        POSSIBILITY OF SUCH DAMAGE.
+
+        </pre>
+
+        @author Chair of Electronic Design Automation, TUM
+
+        @version 0.1
+
+*/
+/**
+        @file
+
+        @brief microbenchmark of data accesses of etiss::SimpleMemSystem
+
+        @detail measures dread/dwrite of etiss::SimpleMemSystem for an increasing number of memory segments. the
+   legacy column is the linear segment search that SimpleMemSystem used before (inlined, without the virtual call and
+   access checks of dread). accesses go to random segments and to a single segment (e.g. the stack).
+
+        usage: benchmark_memsystem [max segments] [accesses]
+
+*/
+
+#include "etiss/SimpleMemSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+/// data access as done by etiss::SimpleMemSystem before the segment lookup was added
+etiss::int32 legacyAccess(std::vector<std::unique_ptr<etiss::MemSegment>> &msegs, etiss::uint64 addr,
+                          etiss::uint8 *buf, etiss::uint32 len)
+{
+    auto it = std::find_if(msegs.begin(), msegs.end(), [addr, len](const std::unique_ptr<etiss::MemSegment> &mseg) {
+        return mseg->payload_in_range(addr, len);
+    });
+    if (it == msegs.end())
+        return etiss::RETURNCODE::DBUS_READ_ERROR;
+    memcpy(buf, (*it)->mem_ + (addr - (*it)->start_addr_), len);
+    return etiss::RETURNCODE::NOERROR;
+}
+
+template <typename F>
+double measure(const std::vector<etiss::uint64> &addrs, F access, size_t &errors)
+{
+    etiss::uint8 buf[4] = { 0 };
+    auto begin = std::chrono::steady_clock::now();
+    for (etiss::uint64 addr : addrs)
+    {
+        if (access(addr, buf) != etiss::RETURNCODE::NOERROR)
+            errors++;
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / addrs.size();
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    size_t maxsegments = argc > 1 ? std::strtoul(argv[1], nullptr, 0) : 64;
+    size_t accesses = argc > 2 ? std::strtoul(argv[2], nullptr, 0) : 10000000;
+    const etiss::uint64 segmentsize = 0x10000;
+    const auto mode = static_cast<etiss::MemSegment::access_t>(etiss::MemSegment::READ | etiss::MemSegment::WRITE);
+
+    std::cout << "segments; access; legacy read [ns]; read [ns]; write [ns]" << std::endl;
+    size_t errors = 0;
+    for (size_t count = 1; count <= maxsegments; count *= 2)
+    {
+        // segments with gaps at a typical RAM base address
+        etiss::SimpleMemSystem sys;
+        std::vector<std::unique_ptr<etiss::MemSegment>> legacy;
+        for (size_t i = 0; i < count; i++)
+        {
+            etiss::uint64 start = 0x80000000 + i * 2 * segmentsize;
+            auto mseg = std::make_unique<etiss::MemSegment>(start, segmentsize, mode, "");
+            sys.add_memsegment(mseg, nullptr, 0);
+            legacy.push_back(std::make_unique<etiss::MemSegment>(start, segmentsize, mode, ""));
+        }
+
+        std::mt19937_64 rng(42);
+        std::vector<etiss::uint64> random(accesses);
+        for (auto &addr : random)
+            addr = 0x80000000 + (rng() % count) * 2 * segmentsize + (rng() % (segmentsize / 4)) * 4;
+        std::vector<etiss::uint64> single(accesses);
+        for (auto &addr : single)
+            addr = 0x80000000 + (count - 1) * 2 * segmentsize + (rng() % (segmentsize / 4)) * 4;
+
+        auto legacyread = [&legacy](etiss::uint64 addr, etiss::uint8 *buf) {
+            return legacyAccess(legacy, addr, buf, 4);
+        };
+        auto read = [&sys](etiss::uint64 addr, etiss::uint8 *buf) { return sys.dread(nullptr, addr, buf, 4); };
+        auto write = [&sys](etiss::uint64 addr, etiss::uint8 *buf) { return sys.dwrite(nullptr, addr, buf, 4); };
+
+        std::cout << count << "; random; " << measure(random, legacyread, errors) << "; "
+                  << measure(random, read, errors) << "; " << measure(random, write, errors) << std::endl;
+        std::cout << count << "; single; " << measure(single, legacyread, errors) << "; "
+                  << measure(single, read, errors) << "; " << measure(single, write, errors) << std::endl;
+    }
+
+    if (errors != 0)
+    {
+        std::cout << "ERROR: " << errors << " accesses failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
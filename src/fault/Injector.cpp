@@ -49,6 +49,8 @@
 #include "fault/Stressor.h"
 #endif
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 
 namespace etiss
@@ -62,6 +64,7 @@ Injector::Injector()
 {
     etiss::log(etiss::VERBOSE, std::string("Called etiss::fault::Injector::Injector()"));
     has_pending_triggers = false;
+    trigger_generation = 0;
 }
 
 void Injector::freeFastFieldAccessPtr(void *)
@@ -106,6 +109,7 @@ bool Injector::cycleAccurateCallback(uint64_t time_ps)
                 {
                     // remove fired trigger
                     unknown_triggers.erase(iter++);
+                    trigger_generation = trigger_generation + 1;
                 }
                 else
                 {
@@ -219,6 +223,90 @@ void Injector::addTrigger(const Trigger &t, int32_t fault_id)
     {
         pending_triggers.push_back(std::pair<Trigger, int32_t>(t, fault_id));
         has_pending_triggers = true;
+        trigger_generation = trigger_generation + 1;
+    }
+}
+
+void Injector::checkpointTriggers()
+{
+#if CXX0X_UP_SUPPORTED
+    std::lock_guard<std::mutex> lock(sync);
+#endif
+    // copies keep the count of META_COUNTER triggers
+    checkpoint_triggers = unknown_triggers;
+    checkpoint_triggers.insert(checkpoint_triggers.end(), pending_triggers.begin(), pending_triggers.end());
+}
+
+void Injector::restoreTriggers()
+{
+#if CXX0X_UP_SUPPORTED
+    std::lock_guard<std::mutex> lock(sync);
+#endif
+    unknown_triggers.clear();
+    pending_triggers = checkpoint_triggers;
+    has_pending_triggers = !pending_triggers.empty();
+    // translated code checks outdated trigger conditions
+    trigger_generation = trigger_generation + 1;
+}
+
+bool Injector::getFieldOffset(const std::string &field, uint64_t &offset, uint64_t &width)
+{
+    return false;
+}
+
+/**
+    adds the condition under which a trigger may fire to the table. META_COUNTER triggers count in fired() and thus
+    need a callback whenever their sub trigger fires
+*/
+static void addTriggerCondition(Injector *injector, const Trigger &t, Injector::TriggerTable &table)
+{
+    switch (t.getType())
+    {
+    case Trigger::META_COUNTER:
+        addTriggerCondition(injector, t.getSubTrigger(), table);
+        return;
+    case Trigger::VARIABLEVALUE:
+    {
+        uint64_t offset, width;
+#if CXX0X_UP_SUPPORTED
+        if (t.getInjector().get() != injector || table.fields == Injector::TriggerTable::MAX_FIELDS ||
+#else
+        if (t.getInjector() != injector || table.fields == Injector::TriggerTable::MAX_FIELDS ||
+#endif
+            !injector->getFieldOffset(t.getTriggerField(), offset, width))
+        {
+            table.always = 1;
+            return;
+        }
+        table.field[table.fields].offset = offset;
+        table.field[table.fields].width = width;
+        table.field[table.fields].value = t.getTriggerFieldValue();
+        table.fields++;
+        return;
+    }
+    case Trigger::TIME:
+        table.time_ps = std::min<uint64_t>(table.time_ps, t.getTriggerTime());
+        return;
+    case Trigger::NOP:
+        return;
+    default: // unresolved TIMERELATIVE
+        table.always = 1;
+        return;
+    }
+}
+
+void Injector::getTriggerTable(TriggerTable &table)
+{
+#if CXX0X_UP_SUPPORTED
+    std::lock_guard<std::mutex> lock(sync);
+#endif
+    table.always = 0;
+    table.time_ps = UINT64_MAX;
+    table.fields = 0;
+    for (const std::list<std::pair<Trigger, int32_t>> *triggers : { &pending_triggers, &unknown_triggers })
+    {
+        for (const auto &t : *triggers)
+            addTriggerCondition(this, t.first, table);
     }
 }
 
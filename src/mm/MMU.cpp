@@ -66,7 +66,8 @@ namespace mm
 {
 
 MMU::MMU(bool hw_ptw, std::string name, bool pid_enabled)
-    : mmu_enabled_(false)
+    : cache_flush_pending(false)
+    , mmu_enabled_(false)
     , mmu_control_reg_val_(0)
     , pid_(0)
     , name_(name)
@@ -115,7 +116,7 @@ int32_t MMU::Translate(const uint64_t vma, uint64_t *const pma_buf, MM_ACCESS ac
 
     if (pid_enabled_)
     {
-        vpn |= pid_ << (ppn_msb_pos + 1);
+        vpn |= ((uint64_t)pid_) << (ppn_msb_pos + 1);
     }
 
     PTE pte_buf = PTE(0);
@@ -186,6 +187,14 @@ void MMU::SignalMMU(uint64_t control_reg_val_)
         etiss::log(etiss::WARNING, "Redundant MMU control register write");
 }
 
+uint32_t MMU::GetPageOffsetBits() const
+{
+    auto page_offset = PTEFormat::Instance().GetFormatMap().find(std::string("PAGEOFFSET"));
+    if (page_offset == PTEFormat::Instance().GetFormatMap().end())
+        etiss::log(etiss::FATALERROR, "Page size offset not defined in PTE format");
+    return page_offset->second.first + 1;
+}
+
 void MMU::Dump()
 {
     using std::cout;